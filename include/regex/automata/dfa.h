@@ -26,5 +26,17 @@ namespace regex
          * Run target against the automata
          */
         bool execute( std::basic_string_view<language::character_type> target ) override;
+        /*
+         * Start a run of the automata, which must outlive the cursor
+         */
+        std::unique_ptr<cursor> make_cursor() override;
+        /*
+         * Number of states
+         */
+        std::size_t size() const;
+        /*
+         * Approximate bytes allocated for the states, their transition tables and the set of accepting states
+         */
+        std::size_t bytes() const;
     };
 } // namespace regex
@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <string_view>
 #include "regex/language/ast.h"
 
@@ -9,8 +10,33 @@ namespace regex
       public:
         virtual ~fa() = default;
         /*
-         *  Run target against the automata
+         *  Run target against the automata. Automata may keep what they build between calls, so calls on one
+         *  automaton must not overlap, whereas cursors may each run on a thread of their own
          */
         virtual bool execute( std::basic_string_view<language::character_type> target ) = 0;
+        /*
+         *  A run of the automata over input which arrives in pieces
+         */
+        class cursor
+        {
+          public:
+            virtual ~cursor() = default;
+            /*
+             *  Return to the input state
+             */
+            virtual void reset() = 0;
+            /*
+             *  Consume target, returning false once no continuation of the input can match
+             */
+            virtual bool advance( std::basic_string_view<language::character_type> target ) = 0;
+            /*
+             *  Check whether the input consumed since the last reset is matched
+             */
+            virtual bool accepted() const = 0;
+        };
+        /*
+         *  Start a run of the automata, which must outlive the cursor
+         */
+        virtual std::unique_ptr<cursor> make_cursor() = 0;
     };
 } // namespace regex
@@ -1,35 +1,116 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <memory>
-#include <set>
+#include <memory_resource>
+#include <optional>
 #include <stack>
 #include <string_view>
+#include <vector>
 
 #include "regex/automata/dfa.h"
 #include "regex/automata/fa.h"
 #include "regex/language/ast.h"
+#include "regex/language/character_class.h"
 #include "regex/state/nstate.h"
+#include "regex/state/onepass.h"
 
 namespace regex
 {
+    /*
+     * The part of the input matched by a capture group, as the offsets of its first and one past its last
+     * character, or npos for both if the group did not take part in the match
+     */
+    struct submatch
+    {
+        static constexpr std::size_t npos = state::unset;
+
+        std::size_t begin = npos;
+        std::size_t end = npos;
+
+        bool operator==( const submatch & ) const = default;
+    };
+
     class nfa : public fa
     {
-        std::set<std::unique_ptr<state::nstate>> states_;
-        state::nstate *input_;
-        state::nstate *output_;
+        friend class pattern_set;
+
+        state::ngraph graph_;
+        state::state_id input_;
+        state::state_id output_;
+        /*
+         * One more than the largest group number, group 0 being the whole match
+         */
+        std::uint32_t groups_ = 1;
+        /*
+         * Built by the first capture, null if the graph is not one-pass
+         */
+        std::shared_ptr<const state::onepass> onepass_;
+        bool onepass_built_ = false;
+        /*
+         * Simulation reused by execute, made on first use and again once the graph has grown
+         */
+        std::unique_ptr<state::nsimulation> simulation_;
+        /*
+         * Move the states of rhs into lhs, splicing the smaller graph onto the larger one.
+         * The input and output of both automata are renumbered to index the combined graph.
+         * Both graphs must be allocated from the same memory resource.
+         */
+        static void merge( nfa &lhs, nfa &rhs );
 
       public:
-        explicit nfa( state::nstate *input, state::nstate *output, std::set<std::unique_ptr<state::nstate>> states );
+        /*
+         * Most states a repetition may expand to, around 140 MB of graph
+         */
+        static constexpr std::size_t state_limit = 1 << 20;
+        /*
+         * The automata built by the from_ functions allocate from the resource of their operands, e.g. an arena
+         * shared by a whole compile. Copying an automaton moves its states into memory from the default resource.
+         */
+        explicit nfa( state::ngraph graph, state::state_id input, state::state_id output );
         explicit nfa( const nfa &other );
         explicit nfa( nfa &&other ) = delete;
         /*
-         * Run target against the automata
+         * Run target against the automata, reusing the simulation of the last call so as not to allocate. Calls
+         * must not overlap, e.g. from two threads, which instead each take a cursor
          */
         bool execute( std::basic_string_view<language::character_type> target ) override;
         /*
-         * Construct the deterministic version from the non-deterministic version
+         * Start a run of the automata, which must outlive the cursor
+         */
+        std::unique_ptr<cursor> make_cursor() override;
+        /*
+         * Run target against the automata, returning the submatch of each group or nullopt if it does not match.
+         * Of the paths matching target, groups are captured from the one preferring the left alternative and the
+         * longest repetition at each choice, as a backtracking matcher would, except that a * or + repetition never
+         * takes an empty iteration after a non-empty one: (a?)+ on "a" captures group 1 as { 0, 1 } where a
+         * backtracking matcher ends on an empty iteration at { 1, 1 }. The optional copies of a {m,n} repetition
+         * do, as a backtracking matcher would: (a?){1,2} on "a" captures group 1 as { 1, 1 }. Automata where every
+         * character continues at most one path are run deterministically, others by simulating every path in
+         * priority order.
+         */
+        std::optional<std::vector<submatch>> capture( std::basic_string_view<language::character_type> target );
+        /*
+         * Construct the deterministic version from the non-deterministic version, allocating the temporaries of
+         * the subset construction from scratch or from an arena of its own if none is given. Each deterministic
+         * state stands for a set of non-deterministic states, and the construction gives up, returning null, once
+         * the sets together would hold more than budget states, which bounds both its time and memory
+         */
+        std::unique_ptr<dfa> to_dfa( std::pmr::memory_resource *scratch = nullptr,
+                                     std::size_t budget = std::numeric_limits<std::size_t>::max() );
+        /*
+         * Number of states
+         */
+        std::size_t size() const;
+        /*
+         * Number of labelled and null transitions
+         */
+        std::size_t transitions() const;
+        /*
+         * Bytes allocated for the states and transitions
          */
-        std::unique_ptr<dfa> to_dfa( );
+        std::size_t bytes() const;
         /*
          *
          *
@@ -39,7 +120,9 @@ namespace regex
          *
          *
          */
-        static std::unique_ptr<nfa> from_character( language::character_type character );
+        static std::unique_ptr<nfa>
+        from_character( language::character_type character,
+                        std::pmr::memory_resource *resource = std::pmr::get_default_resource() );
         /*
          *
          *
@@ -49,17 +132,48 @@ namespace regex
          *
          *
          */
-        static std::unique_ptr<nfa> from_epsilon();
+        static std::unique_ptr<nfa> from_epsilon( std::pmr::memory_resource *resource =
+                                                      std::pmr::get_default_resource() );
         /*
-         *                 a
+         *
+         *
+         *      +---+   \x00-\xff  +---+
+         *      | i |------>-----| o |
+         *      +---+            +---+
+         *
+         *
+         */
+        static std::unique_ptr<nfa> from_any( std::pmr::memory_resource *resource =
+                                                  std::pmr::get_default_resource() );
+        /*
+         *                a-z
          *             ---->---
          *      +---+/          \+---+
-         *      | i |----- b ----| o |
+         *      | i |----0-9-----| o |
          *      +---+\          /+---+
          *             ---->---
-         *                 c
+         *                 _
          */
-        static std::unique_ptr<nfa> from_any();
+        static std::unique_ptr<nfa>
+        from_class( const language::character_class &characters,
+                    std::pmr::memory_resource *resource = std::pmr::get_default_resource() );
+        /*
+         *  e.g. [\x{0}-\x{7ff}], consuming the UTF-8 encoding of a code point one byte at a time
+         *
+         *                  \x00-\x7f
+         *             ------->-------
+         *      +---+/                \+---+
+         *      | i |                  | o |
+         *      +---+\                /+---+
+         *             --->---+---+-->-
+         *           \xc2-\xdf |   | \x80-\xbf
+         *                    +---+
+         *
+         *  Sequences sharing leading byte ranges share their states
+         */
+        static std::unique_ptr<nfa>
+        from_utf8_class( const language::character_class &characters,
+                         std::pmr::memory_resource *resource = std::pmr::get_default_resource() );
         /*
          *
          *
@@ -90,5 +204,37 @@ namespace regex
          *        +--------------------------->----------------------+
          */
         static std::unique_ptr<nfa> from_kleene( std::unique_ptr<nfa> expression );
+        /*
+         *                         +----------------<----------------+
+         *                         |                e                |
+         *                       +---+            +---+      e     +---+
+         *                       | i |------------|   |------>-----| o |
+         *                       +---+            +---+            +---+
+         */
+        static std::unique_ptr<nfa> from_one_or_more( std::unique_ptr<nfa> expression );
+        /*
+         *
+         *
+         *      +---+   e (2g)   +---+            +---+  e (2g+1)  +---+
+         *      | i |------>-----|   |------>-----|   |------>-----| o |
+         *      +---+            +---+            +---+            +---+
+         *
+         *  The null transitions record where group g begins and ends
+         */
+        static std::unique_ptr<nfa> from_group( std::unique_ptr<nfa> expression, std::uint32_t group );
+        /*
+         *  e.g. x{2,4}, each x being a copy of expression spliced into the graph
+         *
+         *      +---+    x    +---+    x    +---+    x    +---+    x    +---+    e    +---+
+         *      | i |---->----|   |---->----|   |---->----|   |---->----|   |---->----| o |
+         *      +---+         +---+         +---+         +---+         +---+         +---+
+         *                                    |      e      |      e                    |
+         *                                    +------>------+------>--------------------+
+         *
+         *  An unbounded max loops back over the last copy as in from_one_or_more. Nested repetitions multiply
+         *  their copies, so throws std::runtime_error rather than grow the graph past state_limit states
+         */
+        static std::unique_ptr<nfa> from_repetition( std::unique_ptr<nfa> expression, std::uint32_t min,
+                                                     std::uint32_t max );
     };
 } // namespace regex
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "regex/automata/fa.h"
+#include "regex/automata/nfa.h"
+#include "regex/state/nstate.h"
+
+namespace regex
+{
+    /*
+     * Many automata combined into one which reads its input once, reporting which of them match it. Each pattern
+     * keeps an accepting state of its own in the combined graph, identified by its index in the combination.
+     *
+     * Subset construction of the whole combination ahead of time may add a state for every combination of
+     * patterns, so each cursor instead adds the deterministic states its input reaches as it reaches them,
+     * starting over from an empty cache should the cache grow past cache_limit.
+     *
+     *      regex::pattern_set set( std::move( automata ) );
+     *      auto c = set.make_pattern_cursor();
+     *      if( c->advance( line ) && c->accepted() ) { for( auto id : c->patterns() ) { ... } }
+     */
+    class pattern_set : public fa
+    {
+      public:
+        using pattern_id = std::uint32_t;
+        /*
+         * Pattern id of a state accepting no pattern
+         */
+        static constexpr pattern_id none = std::numeric_limits<pattern_id>::max();
+        /*
+         * Approximate bytes of deterministic states a cursor holds before it starts over
+         */
+        static constexpr std::size_t cache_limit = 16 << 20;
+        /*
+         * A run of the combined automata, which can also tell which patterns accept the input
+         */
+        class cursor : public fa::cursor
+        {
+          public:
+            /*
+             * Ids of the patterns matching the input consumed since the last reset, ascending
+             */
+            virtual std::span<const pattern_id> patterns() const = 0;
+        };
+        /*
+         * Combine the automata, the id of each pattern being its index in patterns
+         */
+        explicit pattern_set( const std::vector<std::unique_ptr<nfa>> &patterns );
+        explicit pattern_set( const pattern_set & ) = delete;
+        explicit pattern_set( pattern_set && ) = delete;
+        /*
+         * Run target against the automata, matching if any pattern does. The deterministic states built, up to
+         * cache_limit bytes, are kept for the next call until the set is destroyed. Calls of execute and matches
+         * must not overlap, e.g. from two threads, which instead each take a cursor
+         */
+        bool execute( std::basic_string_view<language::character_type> target ) override;
+        /*
+         * Ids of the patterns matching target, ascending, keeping the deterministic states built as execute does
+         */
+        std::vector<pattern_id> matches( std::basic_string_view<language::character_type> target );
+        /*
+         * Start a run of the automata, which must outlive the cursor
+         */
+        std::unique_ptr<fa::cursor> make_cursor() override;
+        /*
+         * Start a run of the automata, which must outlive the cursor
+         */
+        std::unique_ptr<cursor> make_pattern_cursor() const;
+        /*
+         * Number of patterns
+         */
+        std::size_t size() const;
+
+      private:
+        state::ngraph graph_;
+        state::state_id input_;
+        /*
+         * Pattern accepted by each state of the graph, or none
+         */
+        std::vector<pattern_id> accepts_;
+        std::size_t size_;
+        /*
+         * Cursor of execute and matches, made on first use
+         */
+        std::unique_ptr<cursor> cursor_;
+
+        cursor &reset();
+    };
+} // namespace regex
@@ -1,26 +1,56 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <limits>
 #include <memory>
 #include <ostream>
 #include <stack>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "regex/language/alphabet.h"
+#include "regex/language/character_class.h"
 #include "regex/language/parser.h"
+#include "regex/language/utf8.h"
 #include "regex/memory/pool_allocator.h"
 
 namespace regex::language
 {
     struct token
     {
+        /*
+         * Child index of a token without that child
+         */
+        static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
         character_type character;
-        token *_lhs;
-        token *_rhs;
+        /*
+         * Indices of the children within the owning ast
+         */
+        std::uint32_t _lhs = none;
+        std::uint32_t _rhs = none;
+        /*
+         * Index of the character class matched by a '[' token
+         */
+        std::uint32_t _class = 0;
+        /*
+         * Bounds of a '{' token, _max being repetition_unbounded for {n,}
+         */
+        std::uint32_t _min = 0;
+        std::uint32_t _max = 0;
+        /*
+         * Number of a ')' token's group, counting opening parentheses from 1
+         */
+        std::uint32_t _group = 0;
     };
 
+    template <typename Allocator>
+    class simplifier;
+
     template <typename Allocator = std::allocator<token>>
     class ast : public Allocator
     {
@@ -28,275 +58,400 @@ namespace regex::language
         /**
          * Construct ast from an expression
          * @param expression
+         * @param flags
          */
-        ast( std::basic_string_view<character_type> expression )
-            : Allocator()
-            , _root( _parse( expression ) )
+        ast( std::basic_string_view<character_type> expression, syntax_flag flags = syntax_flag::none )
+            : Allocator(), _flags( flags )
         {
+            _parse( expression );
         }
         /**
          * Construct ast from an expression using specified allocator
          * @param expression
          * @param allocator
+         * @param flags
          */
-        ast( std::basic_string_view<character_type> expression, Allocator &&allocator )
-            : Allocator( std::move( allocator ) )
-            , _root( _parse( expression ) )
+        ast( std::basic_string_view<character_type> expression, Allocator &&allocator,
+             syntax_flag flags = syntax_flag::none )
+            : Allocator( std::move( allocator ) ), _flags( flags )
         {
+            _parse( expression );
         }
         /**
          * Move construct from another ast. Leaves other ast empty.
          * @param rhs
          */
         ast( ast &&rhs ) noexcept
-            : _root( rhs._root )
+            : Allocator( std::move( static_cast<Allocator &>( rhs ) ) )
+            , _classes( std::move( rhs._classes ) )
+            , _tokens( rhs._tokens )
+            , _size( rhs._size )
+            , _capacity( rhs._capacity )
+            , _root( rhs._root )
+            , _groups( rhs._groups )
+            , _flags( rhs._flags )
         {
-            rhs._root = nullptr;
+            rhs._tokens = nullptr;
+            rhs._size = rhs._capacity = 0;
+            rhs._root = token::none;
         }
         /**
          * Destroy ast.
          */
         ~ast()
         {
-            _erase( _root );
+            if( _tokens )
+                std::allocator_traits<Allocator>::deallocate( *this, _tokens, _capacity );
         }
         /**
          * Iterate the ast in postfix order
          * @tparam F
-         * @param callback function of signature void(character_type)
+         * @param callback function of signature void(const token &)
          */
         template <typename F>
         void postfix( F callback ) const;
+        /**
+         * Character classes referred to by '[' tokens
+         * @return
+         */
+        const std::vector<character_class> &classes() const
+        {
+            return _classes;
+        }
+        /**
+         * Number of groups, including the whole expression as group 0
+         * @return
+         */
+        std::uint32_t groups() const
+        {
+            return _groups;
+        }
+        /**
+         * Options the expression was read with
+         * @return
+         */
+        syntax_flag flags() const
+        {
+            return _flags;
+        }
+        /**
+         * Upper bound on the tokens parsed from an expression, each character adding at most two
+         * @param expression
+         * @return
+         */
+        static std::size_t capacity( std::basic_string_view<character_type> expression )
+        {
+            return std::max<std::size_t>( 2 * expression.size(), 1 );
+        }
 
       private:
-        token *_root = nullptr;
-        token *_parse( std::basic_string_view<character_type> expression );
-        void _erase( token *node )
+        template <typename>
+        friend class simplifier;
+
+        std::vector<character_class> _classes;
+        /*
+         * Tokens stored contiguously, each child preceding its parent when parsed
+         */
+        token *_tokens = nullptr;
+        std::uint32_t _size = 0;
+        std::uint32_t _capacity = 0;
+        std::uint32_t _root = token::none;
+        std::uint32_t _groups = 1;
+        syntax_flag _flags = syntax_flag::none;
+
+        std::uint32_t _make( const token &t )
         {
-            while( node )
-            {
-                if( node->_rhs )
-                    _erase( node->_rhs );
-                token *tmp = node->_lhs;
-                node->~token();
-                std::allocator_traits<Allocator>::deallocate( *this, node, 1 );
-                node = tmp;
-            }
-        };
+            _tokens[_size] = t;
+            return _size++;
+        }
+        void _parse( std::basic_string_view<character_type> expression );
+        std::uint32_t _parse_alternation( std::basic_string_view<character_type> expression, std::size_t &position,
+                                          std::uint32_t depth );
+        std::uint32_t _parse_concatenation( std::basic_string_view<character_type> expression,
+                                            std::size_t &position, std::uint32_t depth );
+        std::uint32_t _parse_repetition( std::basic_string_view<character_type> expression, std::size_t &position,
+                                         std::uint32_t depth );
+        std::uint32_t _parse_atom( std::basic_string_view<character_type> expression, std::size_t &position,
+                                   std::uint32_t depth );
     };
 
     template <typename Allocator = std::allocator<token>>
-    inline ast<Allocator> parse( std::basic_string_view<character_type> expression )
+    inline ast<Allocator> parse( std::basic_string_view<character_type> expression,
+                                 syntax_flag flags = syntax_flag::none )
     {
-        return regex::language::ast<Allocator>( make_explicit( expression ) );
+        return regex::language::ast<Allocator>( expression, flags );
+    }
+
+    template <typename Allocator>
+    inline ast<Allocator> parse( std::basic_string_view<character_type> expression, Allocator allocator,
+                                 syntax_flag flags = syntax_flag::none )
+    {
+        return { expression, std::move( allocator ), flags };
     }
 
     template <>
-    inline ast<pool_allocator<token>> parse<pool_allocator<token>>( std::basic_string_view<character_type> expression )
+    inline ast<pool_allocator<token>> parse<pool_allocator<token>>( std::basic_string_view<character_type> expression,
+                                                                    syntax_flag flags )
+    {
+        pool_allocator<token> allocator( ast<pool_allocator<token>>::capacity( expression ) );
+        return { expression, std::move( allocator ), flags };
+    }
+    /*
+     * Recursive descent over the grammar
+     *
+     *   alternation   := concatenation ( '|' concatenation )*
+     *   concatenation := repetition repetition*
+     *   repetition    := atom ( '*' | '+' | '?' | '{' bounds '}' )*
+     *   atom          := '(' alternation ')' | class | '.' | character
+     *
+     * recursing only into groups, whose depth is limited by nesting_limit. Binary operators are built left to
+     * right so that every token is emitted after its children.
+     */
+    template <typename Allocator>
+    void ast<Allocator>::_parse( std::basic_string_view<character_type> expression )
     {
-        std::string explicit_expression = make_explicit( expression );
-        pool_allocator<token> allocator( explicit_expression.size() );
-        return { explicit_expression, std::move( allocator ) };
+        _capacity = static_cast<std::uint32_t>( capacity( expression ) );
+        _tokens = std::allocator_traits<Allocator>::allocate( *this, _capacity );
+
+        try
+        {
+            std::size_t position = 0;
+            _root = _parse_alternation( expression, position, 0 );
+
+            if( position != expression.size() )
+                throw std::runtime_error( "Unexpected " + std::string( 1, expression[position] ) + " at " +
+                                          std::to_string( position ) );
+        }
+        catch( ... )
+        {
+            std::allocator_traits<Allocator>::deallocate( *this, _tokens, _capacity );
+            throw;
+        }
     }
 
     template <typename Allocator>
-    token *ast<Allocator>::_parse( std::basic_string_view<character_type> expression )
+    std::uint32_t ast<Allocator>::_parse_alternation( std::basic_string_view<character_type> expression,
+                                                      std::size_t &position, std::uint32_t depth )
     {
-        std::stack<token *> output;
-        std::stack<character_type> ops;
+        std::uint32_t lhs = _parse_concatenation( expression, position, depth );
 
-        auto check_args = [&output]( unsigned short args_needed ) {
-            if( output.size() < args_needed )
-                throw std::runtime_error( "Expected " + std::to_string( args_needed ) + " arguments but only have " +
-                                          std::to_string( output.size() ) );
-        };
+        while( position < expression.size() && expression[position] == '|' )
+        {
+            ++position;
+            const std::uint32_t rhs = _parse_concatenation( expression, position, depth );
+            lhs = _make( { '|', lhs, rhs } );
+        }
+
+        return lhs;
+    }
 
-        token *op, *lhs, *rhs;
+    template <typename Allocator>
+    std::uint32_t ast<Allocator>::_parse_concatenation( std::basic_string_view<character_type> expression,
+                                                        std::size_t &position, std::uint32_t depth )
+    {
+        std::uint32_t lhs = _parse_repetition( expression, position, depth );
 
-        for( character_type character : expression )
+        while( position < expression.size() && expression[position] != '|' && expression[position] != ')' )
         {
-            if( character == '*' || character == '?' || character == '|' || character == '-' || character == '+' )
-            {
-                while( !ops.empty() && ops.top() != '(' && precedence[character] < precedence[ops.top()] )
-                {
-                    switch( ops.top() )
-                    {
-                    case '*':
-                    case '?':
-                    case '+':
-                        check_args( 1 );
-                        lhs = output.top();
-                        output.pop();
-                        op = this->allocate( 1 );
-                        new( op ) token( ops.top(), lhs, nullptr );
-                        output.push( op );
-                        break;
-                    case '-':
-                    case '|':
-                        check_args( 2 );
-                        rhs = output.top();
-                        output.pop();
-                        lhs = output.top();
-                        output.pop();
-                        op = this->allocate( 1 );
-                        new( op ) token( ops.top(), lhs, rhs );
-                        break;
-                    }
-                    ops.pop();
-                }
-                ops.push( character );
-            }
-            else if( character == '(' )
+            const std::uint32_t rhs = _parse_repetition( expression, position, depth );
+            lhs = _make( { '-', lhs, rhs } );
+        }
+
+        return lhs;
+    }
+
+    template <typename Allocator>
+    std::uint32_t ast<Allocator>::_parse_repetition( std::basic_string_view<character_type> expression,
+                                                     std::size_t &position, std::uint32_t depth )
+    {
+        std::uint32_t lhs = _parse_atom( expression, position, depth );
+
+        while( position < expression.size() )
+        {
+            const character_type character = expression[position];
+
+            if( character == '*' || character == '+' || character == '?' )
             {
-                ops.push( character );
+                lhs = _make( { character, lhs } );
+                ++position;
             }
-            else if( character == ')' )
+            else if( character == '{' )
             {
-                while( ops.top() != '(' )
-                {
-                    switch( ops.top() )
-                    {
-                    case '*':
-                    case '?':
-                    case '+':
-                        check_args( 1 );
-                        lhs = output.top();
-                        output.pop();
-                        op = this->allocate( 1 );
-                        new( op ) token( ops.top(), lhs, nullptr );
-                        output.push( op );
-                        break;
-                    case '-':
-                    case '|':
-                        check_args( 2 );
-                        rhs = output.top();
-                        output.pop();
-                        lhs = output.top();
-                        output.pop();
-                        op = this->allocate( 1 );
-                        new( op ) token( ops.top(), lhs, rhs );
-                        output.push( op );
-                        break;
-                    }
-                    ops.pop();
-                }
-                lhs = output.top();
-                output.pop();
-                op = this->allocate( 1 );
-                new( op ) token( character, lhs, nullptr );
-                output.push( op );
-                ops.pop();
+                const std::size_t length = atom_length( expression, position );
+                const auto [min, max] = make_bounds( expression.substr( position, length ) );
+                lhs = _make( { character, lhs, token::none, 0, min, max } );
+                position += length;
             }
             else
             {
-                lhs = this->allocate( 1 );
-                new( lhs ) token( character, nullptr, nullptr );
-                output.push( lhs );
-            }
-        }
-        while( !ops.empty() )
-        {
-            switch( ops.top() )
-            {
-            case '*':
-            case '?':
-            case '+':
-                check_args( 1 );
-                lhs = output.top();
-                output.pop();
-                op = this->allocate( 1 );
-                new( op ) token( ops.top(), lhs, nullptr );
-                output.push( op );
-                break;
-            case '-':
-            case '|':
-                check_args( 2 );
-                rhs = output.top();
-                output.pop();
-                lhs = output.top();
-                output.pop();
-                op = this->allocate( 1 );
-                new( op ) token( ops.top(), lhs, rhs );
-                output.push( op );
-                break;
-            case ')':
-            case '(':
-                check_args( 1 );
-                lhs = output.top();
-                output.pop();
-                op = this->allocate( 1 );
-                new( op ) token( ops.top(), lhs, nullptr );
-                output.push( op );
                 break;
             }
-            ops.pop();
         }
 
-        if( output.size() != 1 )
-            throw std::runtime_error( std::to_string( output.size() - 1 ) + " unmatched arguments remaining" );
-
-        return output.top();
+        return lhs;
     }
 
-    template <typename F>
-    void postfix( token *t, F callback )
+    template <typename Allocator>
+    std::uint32_t ast<Allocator>::_parse_atom( std::basic_string_view<character_type> expression,
+                                               std::size_t &position, std::uint32_t depth )
     {
-        if( t->_lhs )
-            postfix( t->_lhs, callback );
+        if( position >= expression.size() )
+            throw std::runtime_error( "Expected an expression at " + std::to_string( position ) );
+
+        const character_type character = expression[position];
 
-        if( t->_rhs )
-            postfix( t->_rhs, callback );
+        switch( character )
+        {
+        case '(': {
+            if( depth >= nesting_limit )
+                throw std::runtime_error( "Groups nested deeper than " + std::to_string( nesting_limit ) + " at " +
+                                          std::to_string( position ) );
 
-        callback( t->character );
+            const std::size_t open = position++;
+            const std::uint32_t group = _groups++;
+            const std::uint32_t lhs = _parse_alternation( expression, position, depth + 1 );
+
+            if( position >= expression.size() || expression[position] != ')' )
+                throw std::runtime_error( "Unmatched ( at " + std::to_string( open ) );
+
+            ++position;
+            return _make( { ')', lhs, token::none, 0, 0, 0, group } );
+        }
+        case '|':
+        case ')':
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+            throw std::runtime_error( "Expected an expression before " + std::string( 1, character ) + " at " +
+                                      std::to_string( position ) );
+        case '[':
+        case '\\': {
+            const std::size_t length = atom_length( expression, position );
+            _classes.push_back( make_class( expression.substr( position, length ), _flags ) );
+            position += length;
+            return _make( { '[', token::none, token::none, static_cast<std::uint32_t>( _classes.size() - 1 ) } );
+        }
+        case '-':
+            /*
+             * '-' is the concatenation token, so a literal '-' is kept as a class
+             */
+            _classes.emplace_back( '-', '-' );
+            ++position;
+            return _make( { '[', token::none, token::none, static_cast<std::uint32_t>( _classes.size() - 1 ) } );
+        default: {
+            /*
+             * A character encoded in several bytes is a single atom, kept as a class of its code point, as is a
+             * letter matched in either case
+             */
+            const bool multibyte =
+                is_set( _flags, syntax_flag::utf8 ) && static_cast<unsigned char>( character ) >= 0x80;
+            const auto c = multibyte ? utf8::decode( expression, position )
+                                     : static_cast<unsigned char>( expression[position++] );
+            character_class characters( c, c );
+
+            if( is_set( _flags, syntax_flag::case_insensitive ) )
+                characters = characters.fold( max_code_point( _flags ) );
+
+            if( !multibyte && characters.ranges().size() == 1 )
+                return _make( { character } );
+
+            _classes.push_back( std::move( characters ) );
+            return _make( { '[', token::none, token::none, static_cast<std::uint32_t>( _classes.size() - 1 ) } );
+        }
+        }
     }
 
     template <typename Allocator>
     template <typename T>
     void ast<Allocator>::postfix( T callback ) const
     {
-        if( _root )
-            ::regex::language::postfix<T>( _root, callback );
+        if( _root == token::none )
+            return;
+        /*
+         * Explicit stack of tokens, each flagged once its children have been pushed
+         */
+        std::vector<std::pair<std::uint32_t, bool>> pending{ { _root, false } };
+
+        while( !pending.empty() )
+        {
+            auto &[index, expanded] = pending.back();
+            const token &t = _tokens[index];
+
+            if( expanded )
+            {
+                pending.pop_back();
+                callback( t );
+                continue;
+            }
+
+            expanded = true;
+
+            if( t._rhs != token::none )
+                pending.emplace_back( t._rhs, false );
+            if( t._lhs != token::none )
+                pending.emplace_back( t._lhs, false );
+        }
     }
 
     template <typename Allocator>
-    std::string to_string( ast<Allocator> a )
+    std::string to_string( const ast<Allocator> &a )
     {
-        std::stack<std::string> args;
-        std::string arg1, arg2;
+        /*
+         * Each argument with the precedence of its outermost operator, parenthesised where an operand
+         * binds more loosely than its operator, e.g. after ast rewrites have removed the original groups
+         */
+        std::stack<std::pair<std::string, short>> args;
+        std::pair<std::string, short> arg2;
+
+        auto operand = []( std::pair<std::string, short> &&arg, short minimum ) {
+            return arg.second < minimum ? '(' + arg.first + ')' : std::move( arg.first );
+        };
+
+        auto cbk = [&]( const token &t ) {
+            const character_type character = t.character;
 
-        auto cbk = [&]( character_type character ) {
             switch( character )
             {
             case '*':
             case '?':
             case '+':
-                args.top() = args.top() + character;
+                args.top() = { operand( std::move( args.top() ), precedence['('] ) + character, precedence['('] };
                 break;
             case '-':
-                arg2 = args.top();
-                args.pop();
-                arg1 = args.top();
+                arg2 = std::move( args.top() );
                 args.pop();
-                args.push( arg1 + arg2 );
+                args.top() = { operand( std::move( args.top() ), precedence['-'] ), precedence['-'] };
+                args.top().first += operand( std::move( arg2 ), precedence['-'] );
                 break;
             case '|':
-                arg2 = args.top();
+                arg2 = std::move( args.top() );
                 args.pop();
-                arg1 = args.top();
-                args.pop();
-                args.push( arg1 + character + arg2 );
+                args.top() = { std::move( args.top().first ), precedence['|'] };
+                args.top().first += character;
+                args.top().first += arg2.first;
                 break;
             case ')':
             case '(':
-                args.top() = '(' + args.top() + ')';
+                args.top() = { '(' + args.top().first + ')', precedence['('] };
+                break;
+            case '[':
+                args.push( { to_string( a.classes()[t._class] ), precedence['('] } );
+                break;
+            case '{':
+                args.top() = { operand( std::move( args.top() ), precedence['('] ) + '{' + std::to_string( t._min ),
+                               precedence['('] };
+                if( t._max != t._min )
+                    args.top().first += t._max == repetition_unbounded ? "," : ',' + std::to_string( t._max );
+                args.top().first += '}';
                 break;
             default:
-                args.emplace( 1, character );
+                args.push( { std::string( 1, character ), precedence['('] } );
             }
         };
 
         a.postfix( cbk );
 
-        return args.top();
+        return args.top().first;
     }
 } // namespace regex::language
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "regex/language/alphabet.h"
+
+namespace regex::language
+{
+    class character_class
+    {
+      public:
+        using code_point = std::uint32_t;
+        /*
+         * Inclusive range of code points
+         */
+        struct range
+        {
+            code_point lower;
+            code_point upper;
+
+            bool operator==( const range & ) const = default;
+        };
+        /*
+         * The largest code point matched by a single byte
+         */
+        static constexpr code_point byte_max = 0xFF;
+        /*
+         * The largest Unicode code point
+         */
+        static constexpr code_point code_point_max = 0x10FFFF;
+
+        explicit character_class() = default;
+        explicit character_class( code_point lower, code_point upper );
+        /*
+         * Add the code points lower through upper
+         */
+        void insert( code_point lower, code_point upper );
+        /*
+         * Add every code point of other
+         */
+        void insert( const character_class &other );
+        /*
+         * Every code point up to max which is not in this
+         */
+        character_class complement( code_point max = byte_max ) const;
+        /*
+         * Every member along with the other case of each letter, that is of ASCII letters and, when max reaches
+         * beyond a byte, of Latin-1, Greek and Cyrillic letters
+         */
+        character_class fold( code_point max = byte_max ) const;
+        /*
+         * Check whether the code point is a member
+         */
+        bool contains( code_point c ) const;
+        /*
+         * Sorted, disjoint and non-adjacent ranges of the members
+         */
+        const std::vector<range> &ranges() const;
+
+        bool operator==( const character_class & ) const = default;
+        /*
+         * \d
+         */
+        static character_class digit();
+        /*
+         * \w
+         */
+        static character_class word();
+        /*
+         * \s
+         */
+        static character_class space();
+
+      private:
+        std::vector<range> ranges_;
+    };
+    /*
+     * Render as an escaped character or a bracket expression which parses back to the same class
+     */
+    std::basic_string<character_type> to_string( const character_class &c );
+} // namespace regex::language
@@ -1,24 +1,90 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <exception>
 #include <istream>
+#include <limits>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
 
 #include "regex/language/alphabet.h"
+#include "regex/language/character_class.h"
 
 namespace regex::language
 {
     extern const std::array<short, 128> precedence;
+    /*
+     * Upper bound of a repetition without a maximum, e.g. a{2,}
+     */
+    constexpr std::uint32_t repetition_unbounded = std::numeric_limits<std::uint32_t>::max();
+    /*
+     * Largest count accepted in a repetition, each repeat being a copy of the expression in the automaton
+     */
+    constexpr std::uint32_t repetition_limit = 1000;
 
-    constexpr bool is_operator( language::character_type token );
+    /*
+     * Deepest nesting of groups accepted, the parser recursing once per group
+     */
+    constexpr std::uint32_t nesting_limit = 1000;
 
-    constexpr bool is_unary_operator( language::character_type token );
+    /*
+     * Options changing how an expression is read
+     */
+    enum class syntax_flag : unsigned
+    {
+        none = 0,
+        /*
+         * Read the expression and match the input as UTF-8, so that '.', classes and literals match whole
+         * characters and \x{hhhh} escapes any code point
+         */
+        utf8 = 1 << 0,
+        /*
+         * Match letters in either case, folding each literal and class to both cases as it is read so that the
+         * automaton costs nothing more to run
+         */
+        case_insensitive = 1 << 1
+    };
+
+    constexpr syntax_flag operator|( syntax_flag lhs, syntax_flag rhs )
+    {
+        return static_cast<syntax_flag>( static_cast<unsigned>( lhs ) | static_cast<unsigned>( rhs ) );
+    }
+
+    constexpr bool is_set( syntax_flag flags, syntax_flag flag )
+    {
+        return ( static_cast<unsigned>( flags ) & static_cast<unsigned>( flag ) ) != 0;
+    }
+    /*
+     * The largest code point matched under flags
+     */
+    constexpr character_class::code_point max_code_point( syntax_flag flags )
+    {
+        return is_set( flags, syntax_flag::utf8 ) ? character_class::code_point_max : character_class::byte_max;
+    }
 
     using istream = std::basic_istream<language::character_type, std::char_traits<language::character_type>>;
 
-    std::basic_string<character_type> make_explicit( std::basic_string_view<character_type> expression );
+    /*
+     * Length of the escape sequence, bracket expression or repetition starting at position, otherwise 1
+     * e.g. atom_length( "a[bc]d", 1 ) == 4
+     */
+    std::size_t atom_length( std::basic_string_view<character_type> expression, std::size_t position );
+    /*
+     * Check whether an atom is an escape sequence or bracket expression, which parses to a character class
+     */
+    bool is_class( std::basic_string_view<character_type> atom );
+    /*
+     * Characters matched by an escape sequence or bracket expression
+     * e.g. make_class( "[^a-z\\d]" ), make_class( "\\w" ), make_class( "\\." )
+     */
+    character_class make_class( std::basic_string_view<character_type> atom, syntax_flag flags = syntax_flag::none );
+    /*
+     * Minimum and maximum of a repetition, the maximum being repetition_unbounded if absent
+     * e.g. make_bounds( "{2,5}" ), make_bounds( "{3}" ), make_bounds( "{1,}" )
+     */
+    std::pair<std::uint32_t, std::uint32_t> make_bounds( std::basic_string_view<character_type> atom );
 
 } // namespace regex::language
\ No newline at end of file
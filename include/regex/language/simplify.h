@@ -0,0 +1,427 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "regex/language/ast.h"
+#include "regex/language/character_class.h"
+
+namespace regex::language
+{
+    /*
+     * Rewrites an ast into an equivalent, smaller one before it is compiled
+     */
+    template <typename Allocator>
+    class simplifier
+    {
+      public:
+        explicit simplifier( ast<Allocator> &a )
+            : _ast( a )
+        {
+        }
+
+        void operator()()
+        {
+            if( _ast._root != token::none )
+                _simplify( _ast._root );
+        }
+
+      private:
+        ast<Allocator> &_ast;
+        /*
+         * Tokens detached by earlier rewrites, reused before the unused capacity of the ast so that
+         * rewriting never needs more tokens than the parser reserved
+         */
+        std::vector<std::uint32_t> _free;
+
+        using sequence = std::vector<std::uint32_t>;
+
+        token &_at( std::uint32_t index )
+        {
+            return _ast._tokens[index];
+        }
+
+        const token &_at( std::uint32_t index ) const
+        {
+            return _ast._tokens[index];
+        }
+
+        std::uint32_t _make( character_type character, std::uint32_t lhs, std::uint32_t rhs )
+        {
+            if( _free.empty() )
+            {
+                if( _ast._size == _ast._capacity )
+                    throw std::length_error( "Simplified ast exceeds the capacity of the parsed ast" );
+
+                return _ast._make( { character, lhs, rhs } );
+            }
+
+            const std::uint32_t index = _free.back();
+            _free.pop_back();
+            _at( index ) = { character, lhs, rhs };
+
+            return index;
+        }
+
+        void _release( std::uint32_t index )
+        {
+            _free.push_back( index );
+        }
+
+        bool _equal( std::uint32_t lhs, std::uint32_t rhs ) const
+        {
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> pending{ { lhs, rhs } };
+
+            while( !pending.empty() )
+            {
+                const auto [l, r] = pending.back();
+                pending.pop_back();
+
+                if( l == r )
+                    continue;
+                if( l == token::none || r == token::none )
+                    return false;
+
+                const token &a = _at( l ), &b = _at( r );
+
+                if( a.character != b.character )
+                    return false;
+                if( a.character == '[' && !( _ast._classes[a._class] == _ast._classes[b._class] ) )
+                    return false;
+                if( a.character == '{' && ( a._min != b._min || a._max != b._max ) )
+                    return false;
+
+                pending.emplace_back( a._lhs, b._lhs );
+                pending.emplace_back( a._rhs, b._rhs );
+            }
+
+            return true;
+        }
+        /*
+         * Add the characters matched by a single character token, returning false for any other token
+         */
+        bool _single_character( std::uint32_t index, character_class &characters ) const
+        {
+            const token &t = _at( index );
+
+            switch( t.character )
+            {
+            case '[':
+                characters.insert( _ast._classes[t._class] );
+                return true;
+            case '.':
+                characters.insert( 0, max_code_point( _ast._flags ) );
+                return true;
+            default:
+                if( t._lhs != token::none || t._rhs != token::none )
+                    return false;
+                characters.insert( static_cast<unsigned char>( t.character ),
+                                   static_cast<unsigned char>( t.character ) );
+                return true;
+            }
+        }
+        /*
+         * Simplify the tree whose root is stored in slot, children first, replacing the slot with the new root
+         */
+        void _simplify( std::uint32_t &slot )
+        {
+            std::vector<std::pair<std::uint32_t *, bool>> pending{ { &slot, false } };
+
+            while( !pending.empty() )
+            {
+                auto &[current, expanded] = pending.back();
+                std::uint32_t *const root = current;
+                token &t = _at( *root );
+
+                if( expanded )
+                {
+                    pending.pop_back();
+                    *root = _rewrite( *root );
+                    continue;
+                }
+                /*
+                 * Alternatives are simplified after flattening so that nested alternations are visited once
+                 */
+                if( t.character == '|' )
+                {
+                    pending.pop_back();
+                    *root = _simplify_alternation( *root );
+                    continue;
+                }
+
+                expanded = true;
+
+                if( t._rhs != token::none )
+                    pending.emplace_back( &t._rhs, false );
+                if( t._lhs != token::none )
+                    pending.emplace_back( &t._lhs, false );
+            }
+        }
+
+        std::uint32_t _rewrite( std::uint32_t index )
+        {
+            switch( _at( index ).character )
+            {
+            case ')':
+                return _simplify_group( index );
+            case '*':
+            case '+':
+            case '?':
+                return _simplify_closure( index );
+            case '{':
+                return _simplify_repetition( index );
+            default:
+                return index;
+            }
+        }
+        /*
+         * (a) => a
+         */
+        std::uint32_t _simplify_group( std::uint32_t index )
+        {
+            const std::uint32_t child = _at( index )._lhs;
+            _release( index );
+            return child;
+        }
+        /*
+         * a** => a*, (a*)? => a*, (a+)? => a*, a++ => a+, a?? => a?
+         */
+        std::uint32_t _simplify_closure( std::uint32_t index )
+        {
+            const token &t = _at( index );
+            token &child = _at( t._lhs );
+
+            if( child.character != '*' && child.character != '+' && child.character != '?' )
+                return index;
+
+            if( child.character != t.character )
+                child.character = '*';
+
+            return _simplify_group( index );
+        }
+        /*
+         * a{1} => a, a{0,1} => a?, a{0,} => a*, a{1,} => a+
+         */
+        std::uint32_t _simplify_repetition( std::uint32_t index )
+        {
+            token &t = _at( index );
+
+            if( t._min == 1 && t._max == 1 )
+                return _simplify_group( index );
+
+            if( t._min == 0 && t._max == 1 )
+                t.character = '?';
+            else if( t._min == 0 && t._max == repetition_unbounded )
+                t.character = '*';
+            else if( t._min == 1 && t._max == repetition_unbounded )
+                t.character = '+';
+            else
+                return index;
+
+            return _simplify_closure( index );
+        }
+        /*
+         * Append the operands of a chain of character operators in order, releasing the operators
+         */
+        void _flatten( std::uint32_t index, character_type character, sequence &output )
+        {
+            sequence pending{ index };
+
+            while( !pending.empty() )
+            {
+                const std::uint32_t current = pending.back();
+                pending.pop_back();
+                const token &t = _at( current );
+
+                if( t.character == character )
+                {
+                    pending.push_back( t._rhs );
+                    pending.push_back( t._lhs );
+                    _release( current );
+                }
+                else
+                {
+                    output.push_back( current );
+                }
+            }
+        }
+
+        std::uint32_t _join( const sequence &operands, character_type character )
+        {
+            std::uint32_t result = operands.back();
+
+            for( auto operand = std::next( std::crbegin( operands ) ); operand != std::crend( operands ); ++operand )
+            {
+                result = _make( character, *operand, result );
+            }
+
+            return result;
+        }
+        /*
+         * Factor out common prefixes of adjacent alternatives, dropping duplicates among them, and merge
+         * single character alternatives into one class
+         * e.g. foo|foobar|fox => fo(o(bar)?|x), a|b|[c-e] => [a-e]
+         */
+        std::uint32_t _simplify_alternation( std::uint32_t index )
+        {
+            std::vector<sequence> sequences;
+            _alternatives( index, sequences );
+
+            return _alternation( _factor( sequences ) );
+        }
+        /*
+         * Collect the simplified alternatives of a token in order, each as a sequence of concatenated tokens
+         */
+        void _alternatives( std::uint32_t index, std::vector<sequence> &sequences )
+        {
+            sequence pending{ index };
+
+            while( !pending.empty() )
+            {
+                std::uint32_t current = pending.back();
+                pending.pop_back();
+                const token &t = _at( current );
+
+                if( t.character == '|' || t.character == ')' )
+                {
+                    if( t._rhs != token::none )
+                        pending.push_back( t._rhs );
+                    pending.push_back( t._lhs );
+                    _release( current );
+                    continue;
+                }
+
+                _simplify( current );
+
+                if( _at( current ).character == '|' )
+                {
+                    sequence simplified;
+                    _flatten( current, '|', simplified );
+
+                    for( const std::uint32_t alternative : simplified )
+                        _flatten( alternative, '-', sequences.emplace_back() );
+                }
+                else
+                {
+                    _flatten( current, '-', sequences.emplace_back() );
+                }
+            }
+        }
+        /*
+         * Factor the common prefix out of each run of adjacent sequences starting with the same token
+         */
+        sequence _factor( std::vector<sequence> &sequences )
+        {
+            sequence alternatives;
+
+            for( std::size_t first = 0; first < sequences.size(); )
+            {
+                const sequence &head = sequences[first];
+                std::size_t last = first + 1;
+
+                while( last < sequences.size() && _equal( head.front(), sequences[last].front() ) )
+                    ++last;
+
+                sequence factored;
+
+                if( last > first + 1 )
+                {
+                    std::size_t prefix = 1;
+
+                    while( std::all_of( std::next( std::cbegin( sequences ), first + 1 ),
+                                        std::next( std::cbegin( sequences ), last ), [&]( const sequence &s ) {
+                                            return prefix < head.size() && prefix < s.size() &&
+                                                   _equal( head[prefix], s[prefix] );
+                                        } ) )
+                        ++prefix;
+
+                    factored.assign( std::cbegin( head ), std::next( std::cbegin( head ), prefix ) );
+
+                    std::vector<sequence> suffixes;
+                    bool optional = false;
+
+                    for( std::size_t i = first; i < last; ++i )
+                    {
+                        if( i != first )
+                        {
+                            for( std::size_t j = 0; j < prefix; ++j )
+                                _release( sequences[i][j] );
+                        }
+
+                        if( sequences[i].size() == prefix )
+                            optional = true;
+                        else
+                            suffixes.emplace_back( std::next( std::cbegin( sequences[i] ), prefix ),
+                                                   std::cend( sequences[i] ) );
+                    }
+
+                    if( !suffixes.empty() )
+                    {
+                        const std::uint32_t tail = _alternation( _factor( suffixes ) );
+
+                        factored.push_back( optional ? _simplify_closure( _make( '?', tail, token::none ) ) : tail );
+                    }
+                }
+                else
+                {
+                    factored.assign( std::cbegin( head ), std::cend( head ) );
+                }
+
+                alternatives.push_back( _join( factored, '-' ) );
+                first = last;
+            }
+
+            return alternatives;
+        }
+        /*
+         * Join alternatives, merging those matching a single character into one class
+         */
+        std::uint32_t _alternation( const sequence &alternatives )
+        {
+            character_class characters;
+            std::uint32_t merged = token::none;
+            std::size_t count = 0;
+            sequence remaining;
+
+            for( const std::uint32_t alternative : alternatives )
+            {
+                if( _single_character( alternative, characters ) )
+                {
+                    if( count++ == 0 )
+                    {
+                        merged = alternative;
+                        remaining.push_back( alternative );
+                    }
+                    else
+                    {
+                        _release( alternative );
+                    }
+                }
+                else
+                {
+                    remaining.push_back( alternative );
+                }
+            }
+
+            if( count > 1 )
+            {
+                _ast._classes.push_back( std::move( characters ) );
+                _at( merged ).character = '[';
+                _at( merged )._class = static_cast<std::uint32_t>( _ast._classes.size() - 1 );
+            }
+
+            return _join( remaining, '|' );
+        }
+    };
+    /*
+     * Rewrite the ast into an equivalent one with fewer tokens
+     */
+    template <typename Allocator>
+    void simplify( ast<Allocator> &a )
+    {
+        simplifier<Allocator>{ a }();
+    }
+} // namespace regex::language
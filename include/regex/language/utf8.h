@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/language/alphabet.h"
+#include "regex/language/character_class.h"
+
+namespace regex::language::utf8
+{
+    /*
+     * Ranges of bytes matching each byte of a UTF-8 encoded character, in order
+     * e.g. U+0080 through U+07FF is [\xc2-\xdf][\x80-\xbf]
+     */
+    struct sequence
+    {
+        std::array<character_class::range, 4> bytes;
+        std::size_t size;
+
+        bool operator==( const sequence & ) const = default;
+    };
+    /*
+     * Decode the character encoded at position, leaving position after it. Throws on an invalid encoding
+     */
+    character_class::code_point decode( std::basic_string_view<character_type> text, std::size_t &position );
+    /*
+     * Append the encoding of c
+     */
+    void encode( character_class::code_point c, std::basic_string<character_type> &output );
+    /*
+     * Byte sequences matching exactly the encodings of the code points in characters, surrogates having none.
+     * Each sequence covers code points of a single encoded length
+     * e.g. sequences( [\x{0}-\x{10ffff}] ) is [\x00-\x7f], [\xc2-\xdf][\x80-\xbf], ...
+     */
+    std::vector<sequence> sequences( const character_class &characters );
+} // namespace regex::language::utf8
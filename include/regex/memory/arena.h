@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace regex::memory
+{
+    /*
+     * Monotonic memory resource which carves allocations out of a list of chunks, each chunk at least double
+     * the size of the one before. Deallocation does nothing; all memory is returned at once by release() or
+     * on destruction, so temporaries built in an arena are freed in constant time.
+     */
+    class arena : public std::pmr::memory_resource
+    {
+      public:
+        /*
+         * Size of the first chunk unless another is requested
+         */
+        static constexpr std::size_t default_chunk_size = 4096;
+
+        explicit arena( std::size_t initial_size = default_chunk_size,
+                        std::pmr::memory_resource *upstream = std::pmr::get_default_resource() );
+        arena( const arena & ) = delete;
+        arena &operator=( const arena & ) = delete;
+        ~arena() override;
+        /*
+         * Return every chunk to the upstream resource
+         */
+        void release();
+        /*
+         * Bytes handed out since construction or the last release
+         */
+        std::size_t allocated() const;
+        /*
+         * Bytes obtained from the upstream resource, including the chunk headers
+         */
+        std::size_t reserved() const;
+
+      private:
+        /*
+         * Header at the start of each chunk, linking it to the previous chunk
+         */
+        struct chunk
+        {
+            chunk *previous;
+            std::size_t size;
+        };
+
+        std::pmr::memory_resource *upstream_;
+        chunk *chunks_ = nullptr;
+        std::byte *current_ = nullptr;
+        std::byte *end_ = nullptr;
+        std::size_t next_size_;
+        std::size_t allocated_ = 0;
+        std::size_t reserved_ = 0;
+
+        void grow( std::size_t bytes, std::size_t alignment );
+
+        void *do_allocate( std::size_t bytes, std::size_t alignment ) override;
+        void do_deallocate( void *p, std::size_t bytes, std::size_t alignment ) override;
+        bool do_is_equal( const std::pmr::memory_resource &other ) const noexcept override;
+    };
+} // namespace regex::memory
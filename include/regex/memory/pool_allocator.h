@@ -3,6 +3,12 @@
 #include <cstdlib>
 #include <memory>
 
+#include "regex/memory/arena.h"
+
+/*
+ * Allocator handing out objects from an arena which is sized for n objects up front and grows in chunks
+ * once they are exhausted. Deallocation does nothing; the memory is freed with the allocator.
+ */
 template <typename T> class pool_allocator
 {
   public:
@@ -12,33 +18,20 @@ template <typename T> class pool_allocator
     using is_always_equal = std::false_type;
 
     pool_allocator( pool_allocator &&rhs ) noexcept
+        : _arena( std::move( rhs._arena ) )
     {
-        std::swap( _begin, rhs._begin );
-        std::swap( _end, rhs._end );
-        std::swap( _end_of_storage, rhs._end_of_storage );
     }
 
     pool_allocator( size_type n )
+        : _arena( std::make_unique<regex::memory::arena>( n * sizeof( T ) ) )
     {
-        _begin = static_cast<pointer>( ::operator new( n * sizeof( T ) ) );
-        _end = _begin;
-        _end_of_storage = _begin + n;
-    }
-
-    ~pool_allocator()
-    {
-        if( _begin )
-            ::operator delete( _begin );
     }
 
     /// Storage and lifetime operations
 
     pointer allocate( size_type n )
     {
-        if( _end + n > _end_of_storage )
-            throw std::bad_alloc();
-
-        return _end++;
+        return static_cast<pointer>( _arena->allocate( n * sizeof( T ), alignof( T ) ) );
     }
 
     void deallocate( pointer p, size_type n )
@@ -64,7 +57,5 @@ template <typename T> class pool_allocator
 
     /// Influence on container operations
   private:
-    pointer _begin = nullptr;
-    pointer _end = nullptr;
-    pointer _end_of_storage = nullptr;
+    std::unique_ptr<regex::memory::arena> _arena;
 };
@@ -14,21 +14,37 @@ namespace regex::state
     class dstate
     {
       public:
-        using transition_label_type = language::character_type;
+        using transition_label_type = unsigned char;
         using group_type = std::set<const dstate *>;
-        using transitions_type = std::map<transition_label_type, dstate *>;
+        /*
+         * A transition consuming a single character within lower and upper inclusive
+         */
+        struct transition
+        {
+            transition_label_type lower;
+            transition_label_type upper;
+            dstate *target;
+        };
+        /*
+         * Disjoint transitions sorted by label
+         */
+        using transitions_type = std::vector<transition>;
 
         explicit dstate() = default;
         explicit dstate( const dstate & ) = delete;
         explicit dstate( dstate && ) = delete;
         /*
-         * Connect this to target via transition_label
+         * Connect this to target via the characters lower through upper, which must follow any existing labels
          */
-        void connect( dstate *target, transition_label_type transition_label );
+        void connect( dstate *target, transition_label_type lower, transition_label_type upper );
         /*
-         * Get the next nstate transitions
+         * Get the next dstate transitions
          */
         const transitions_type &transitions() const;
+        /*
+         * Get the state reached by consuming character, or nullptr
+         */
+        const dstate *next( transition_label_type character ) const;
 
       private:
         transitions_type transitions_;
@@ -37,5 +53,5 @@ namespace regex::state
      * Execute target string, returning on a match or false otherwise
      */
     bool execute( const dstate *input, const dstate::group_type &ouputs,
-                  std::basic_string_view<dstate::transition_label_type> target );
-} // namespace regex::state
\ No newline at end of file
+                  std::basic_string_view<language::character_type> target );
+} // namespace regex::state
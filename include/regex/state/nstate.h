@@ -1,9 +1,10 @@
 #pragma once
 
-#include <algorithm>
-#include <map>
-#include <memory>
-#include <set>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -11,35 +12,204 @@
 
 namespace regex::state
 {
+    /*
+     * Index of a state within the graph that owns it
+     */
+    using state_id = std::uint32_t;
+
     class nstate
     {
       public:
-        using transition_label_type = language::character_type;
-        using group_type = std::set<const nstate *>;
-        using transitions_type = std::map<transition_label_type, group_type>;
+        using transition_label_type = unsigned char;
+        /*
+         * A transition consuming a single character within lower and upper inclusive
+         */
+        struct transition
+        {
+            state_id source;
+            transition_label_type lower;
+            transition_label_type upper;
+            state_id target;
+        };
         /*
-         * The null transition which consumes no characters
+         * Tag of a null transition which records nothing
          */
-        static const transition_label_type epsilon;
+        static constexpr std::uint32_t untagged = std::numeric_limits<std::uint32_t>::max();
+        /*
+         * The null transition which consumes no characters, optionally recording the position it is taken at
+         * in the capture slot tag
+         */
+        struct epsilon
+        {
+            state_id source;
+            state_id target;
+            std::uint32_t tag = untagged;
+        };
 
-        explicit nstate() = default;
-        explicit nstate( const nstate & ) = delete;
-        explicit nstate( nstate && ) = delete;
+      private:
+        friend class ngraph;
+        /*
+         * Ranges into the flat transition arrays of the owning ngraph
+         */
+        std::uint32_t transitions_begin_ = 0;
+        std::uint32_t transitions_end_ = 0;
+        std::uint32_t epsilons_begin_ = 0;
+        std::uint32_t epsilons_end_ = 0;
+    };
+    /*
+     * Contiguous storage for the states of a non-deterministic automaton. States are indices into a single
+     * vector and their transitions are ranges of two flat arrays, one for labelled and one for null transitions.
+     * Transitions may be added in any order; they are grouped by source state on compact().
+     */
+    class ngraph
+    {
+      public:
+        /*
+         * Construct an empty graph whose states and transitions are allocated from resource
+         */
+        explicit ngraph( std::pmr::memory_resource *resource = std::pmr::get_default_resource() );
+        /*
+         * Copy other into memory from the default resource
+         */
+        ngraph( const ngraph & ) = default;
+        /*
+         * Copy other into memory from resource
+         */
+        ngraph( const ngraph &other, std::pmr::memory_resource *resource );
+        ngraph( ngraph && ) = default;
+        ngraph &operator=( const ngraph & ) = default;
+        ngraph &operator=( ngraph && ) = default;
+        /*
+         * Append a new state without transitions
+         */
+        state_id add_state();
+        /*
+         * Connect source to target via the characters lower through upper
+         */
+        void connect( state_id source, state_id target, nstate::transition_label_type lower,
+                      nstate::transition_label_type upper );
+        /*
+         * Connect source to target via the null transition
+         */
+        void connect( state_id source, state_id target );
+        /*
+         * Connect source to target via the null transition, recording its position in capture slot tag
+         */
+        void connect_tagged( state_id source, state_id target, std::uint32_t tag );
+        /*
+         * Append all states and transitions of other, returning the offset added to its state ids
+         */
+        state_id splice( const ngraph &other );
+        /*
+         * Group the transitions by source state, preserving the order in which they were added
+         */
+        void compact();
+        /*
+         * Get the labelled transitions leaving state. Requires compact()
+         */
+        std::span<const nstate::transition> transitions( state_id state ) const;
+        /*
+         * Get every labelled transition
+         */
+        std::span<const nstate::transition> transitions() const;
         /*
-         * Connect this to target via transition_label
+         * Get the null transitions leaving state. Requires compact()
          */
-        void connect( nstate *target, transition_label_type transition_label );
+        std::span<const nstate::epsilon> epsilons( state_id state ) const;
         /*
-         * Get the next nstate transitions
+         * Get every null transition
          */
-        const transitions_type &transitions() const;
+        std::span<const nstate::epsilon> epsilons() const;
+        /*
+         * Number of states
+         */
+        std::size_t size() const;
+        /*
+         * Bytes allocated for the states and transitions
+         */
+        std::size_t bytes() const;
+        /*
+         * The memory resource states and transitions are allocated from
+         */
+        std::pmr::memory_resource *resource() const;
+
+      private:
+        std::pmr::vector<nstate> states_;
+        std::pmr::vector<nstate::transition> transitions_;
+        std::pmr::vector<nstate::epsilon> epsilons_;
+        bool compact_ = true;
+    };
+    /*
+     * Set of states with constant time insertion, membership and clearing
+     */
+    class sparse_set
+    {
+      public:
+        explicit sparse_set( std::size_t capacity );
+
+        bool insert( state_id state );
+
+        bool contains( state_id state ) const;
+
+        void clear();
+
+        std::span<const state_id> states() const;
+
+      private:
+        std::vector<state_id> dense_;
+        std::vector<std::uint32_t> sparse_;
+        std::uint32_t size_ = 0;
+    };
+    /*
+     * Simulation of a graph over input consumed in pieces, holding the set of states reached so far.
+     * Requires compact()
+     */
+    class nsimulation
+    {
+      public:
+        explicit nsimulation( const ngraph &graph, state_id start, state_id finish );
+        /*
+         * Return to the closure of the start state
+         */
+        void reset();
+        /*
+         * Consume target, returning false once no states remain
+         */
+        bool advance( std::basic_string_view<language::character_type> target );
+        /*
+         * Check whether the input consumed since the last reset is matched
+         */
+        bool accepted() const;
+        /*
+         * Check whether this still simulates graph from start to finish, which no longer holds once states are
+         * added to the graph
+         */
+        bool simulates( const ngraph &graph, state_id start, state_id finish ) const;
 
       private:
-        transitions_type transitions_;
+        const ngraph &graph_;
+        state_id start_;
+        state_id finish_;
+        std::size_t size_;
+        sparse_set current_;
+        sparse_set next_;
+        std::vector<state_id> pending_;
     };
     /*
-     * Execute target string, returning on a match or false otherwise
+     * Execute target string, returning on a match or false otherwise. Requires compact()
+     */
+    bool execute( const ngraph &graph, state_id start, state_id finish,
+                  std::basic_string_view<language::character_type> target );
+    /*
+     * Capture slot of a tag which was never reached
+     */
+    constexpr std::size_t unset = std::numeric_limits<std::size_t>::max();
+    /*
+     * Execute target string, returning the positions recorded in each of slots capture slots by the highest
+     * priority path to finish, or nullopt if it does not match. Null transitions leaving a state take priority in
+     * the order they were added. Requires compact()
      */
-    bool execute( const nstate *start, const nstate *finish,
-                  std::basic_string_view<nstate::transition_label_type> target );
-} // namespace regex::state
\ No newline at end of file
+    std::optional<std::vector<std::size_t>> capture( const ngraph &graph, state_id start, state_id finish,
+                                                     std::size_t slots,
+                                                     std::basic_string_view<language::character_type> target );
+} // namespace regex::state
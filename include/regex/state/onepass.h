@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "regex/language/alphabet.h"
+#include "regex/state/nstate.h"
+
+namespace regex::state
+{
+    /*
+     * Deterministic automaton recording capture slots, for graphs in which every character of any input can
+     * continue at most one path. Each state is a state of the graph reached by a labelled transition, and each
+     * transition carries the tags of the null transitions taken before its character, so capturing costs a
+     * table lookup per character instead of a simulation of every thread.
+     */
+    class onepass
+    {
+      public:
+        /*
+         * Largest number of states built before giving up, each taking a row of 256 transitions
+         */
+        static constexpr std::size_t state_limit = 1024;
+        /*
+         * Build the automaton for graph, or nullopt if some input can continue more than one path or the
+         * state limit is exceeded. Requires compact()
+         */
+        static std::optional<onepass> build( const ngraph &graph, state_id start, state_id finish,
+                                             std::size_t slots );
+        /*
+         * Execute target string, returning the positions recorded in each capture slot or nullopt if it does not
+         * match, as state::capture does
+         */
+        std::optional<std::vector<std::size_t>> capture(
+            std::basic_string_view<language::character_type> target ) const;
+        /*
+         * Number of states
+         */
+        std::size_t size() const;
+
+      private:
+        static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+        /*
+         * The next state and the offset within tags_ of the tags recorded before moving to it
+         */
+        struct action
+        {
+            std::uint32_t next = none;
+            std::uint32_t tags = 0;
+        };
+
+        explicit onepass( std::size_t slots );
+
+        std::size_t slots_;
+        /*
+         * 256 actions per state
+         */
+        std::vector<action> transitions_;
+        /*
+         * Offset within tags_ of the tags recorded when input ends in each state, or none if it does not match
+         */
+        std::vector<std::uint32_t> accepts_;
+        /*
+         * Lists of tags, each a count followed by that many slots. The empty list is at offset 0
+         */
+        std::vector<std::uint32_t> tags_;
+    };
+} // namespace regex::state
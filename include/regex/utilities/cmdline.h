@@ -5,7 +5,9 @@
 #include <filesystem>
 #include <initializer_list>
 #include <map>
+#include <optional>
 #include <ostream>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -35,7 +37,18 @@ namespace regex::cmd
          */
         void add_positional( const std::string &var, type, const std::string &description = std::string() );
         /*
-         *  Add optional argument
+         *  Add positional argument taking every argument after the other positionals, if any,
+         *  fetched as std::vector<std::string>
+         *  e.g. add_variadic( "filenames" );
+         */
+        void add_variadic( const std::string &var, const std::string &description = std::string() );
+        /*
+         *  Let a positional go unsupplied when the optional is, fetching it then as an empty value
+         *  e.g. waive( "expression", "-f" );
+         */
+        void waive( const std::string &positional, const std::string &optional );
+        /*
+         *  Add optional argument, accepting only the string literals of options if any are given
          *  e.g. add_optional( "-f", "filename", type::integral );
          */
         void add_optional( const std::string &arg, const std::string &var, type, const std::any &def,
@@ -63,7 +76,7 @@ namespace regex::cmd
 
         bool get_flag( const std::string &flag )
         {
-            return args_.contains( flag );
+            return get_argument<bool>( flag );
         };
 
       private:
@@ -71,8 +84,11 @@ namespace regex::cmd
         std::string error_, description_;
         std::map<std::string, std::any> args_;
         std::vector<std::tuple<std::string, type, std::string>> positionals_;
+        std::optional<std::tuple<std::string, std::string>> variadic_;
         std::map<std::string, std::tuple<std::string, type, std::string, std::vector<std::any>>> optionals_;
         std::map<std::string, std::tuple<std::string, std::string>> flags_;
+        std::map<std::string, std::string> waivers_;
+        std::set<std::string> supplied_;
     };
 
     std::ostream &operator<<( std::ostream &os, const cmdline & );
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <memory_resource>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include "regex/automata/dfa.h"
 #include "regex/automata/nfa.h"
+#include "regex/automata/pattern_set.h"
 #include "regex/language/alphabet.h"
 #include "regex/language/ast.h"
 
@@ -13,21 +19,83 @@ namespace regex
     enum class compile_flag
     {
         nfa,
-        dfa
+        dfa,
+        /*
+         * A pattern_set of the one expression, adding deterministic states as the input reaches them
+         */
+        lazy,
+        /*
+         * Whichever of the above suits the expression, as told by compile_stats::engine:
+         *
+         *      literals, and alternations of them, as a dfa, having a state per character at most
+         *      otherwise a dfa if subset construction stays within automatic_budget
+         *      otherwise lazy
+         */
+        automatic
+    };
+    /*
+     * Non-deterministic states, summed over the sets making up each deterministic state, which subset construction
+     * of compile_flag::automatic may reach before it gives up for compile_flag::lazy, a few milliseconds of work
+     */
+    constexpr std::size_t automatic_budget = 1 << 15;
+    /*
+     * What a compile produced and what it cost, e.g. to reject expressions too large to be matched in production
+     */
+    struct compile_stats
+    {
+        /*
+         * Engine compiled to, never automatic
+         */
+        compile_flag engine = compile_flag::nfa;
+        /*
+         * Tokens of the simplified ast
+         */
+        std::size_t ast_nodes = 0;
+        /*
+         * States, labelled and null transitions and bytes of the non-deterministic automaton
+         */
+        std::size_t nfa_states = 0;
+        std::size_t nfa_transitions = 0;
+        std::size_t nfa_bytes = 0;
+        /*
+         * States and approximate bytes of the deterministic automaton, 0 unless compiled to one
+         */
+        std::size_t dfa_states = 0;
+        std::size_t dfa_bytes = 0;
+        /*
+         * Time spent in each phase
+         */
+        std::chrono::nanoseconds parse_time{};
+        std::chrono::nanoseconds simplify_time{};
+        std::chrono::nanoseconds nfa_time{};
+        std::chrono::nanoseconds dfa_time{};
+        /*
+         * Bytes held at once while compiling, i.e. every chunk of the scratch arena, which only grows, along
+         * with the automaton copied out of it
+         */
+        std::size_t peak_bytes = 0;
     };
 
+    /*
+     * Compile the ast to its finite automaton, allocating the states from resource
+     */
     template <typename Allocator>
-    std::unique_ptr<nfa> compile_nfa( const language::ast<Allocator> &a )
+    std::unique_ptr<nfa> compile_nfa( const language::ast<Allocator> &a,
+                                      std::pmr::memory_resource *resource = std::pmr::get_default_resource() )
     {
         std::stack<std::unique_ptr<nfa>> result;
+        const bool utf8 = language::is_set( a.flags(), language::syntax_flag::utf8 );
 
-        auto generator = [&result]( language::character_type character ) {
+        auto generator = [&result, &a, resource, utf8]( const language::token &t ) {
             std::unique_ptr<regex::nfa> lhs, rhs;
 
-            switch( character )
+            switch( t.character )
             {
             case '.':
-                result.push( nfa::from_any() );
+                result.push( utf8 ? nfa::from_utf8_class( language::character_class(
+                                                              0, language::character_class::code_point_max ),
+                                                          resource )
+                                  : nfa::from_any( resource ) );
                 break;
             case '|':
                 rhs = std::move( result.top() );
@@ -51,19 +119,29 @@ namespace regex
             case '?':
                 lhs = std::move( result.top() );
                 result.pop();
-                result.push( nfa::from_alternation( nfa::from_epsilon(), std::move( lhs ) ) );
+                result.push( nfa::from_alternation( std::move( lhs ), nfa::from_epsilon( resource ) ) );
                 break;
             case '+':
                 lhs = std::move( result.top() );
                 result.pop();
-                rhs = std::make_unique<regex::nfa>( *lhs );
-                result.push( nfa::from_concatenation( std::move( lhs ), nfa::from_kleene( std::move( rhs ) ) ) );
+                result.push( nfa::from_one_or_more( std::move( lhs ) ) );
+                break;
+            case '[':
+                result.push( utf8 ? nfa::from_utf8_class( a.classes()[t._class], resource )
+                                  : nfa::from_class( a.classes()[t._class], resource ) );
+                break;
+            case '{':
+                lhs = std::move( result.top() );
+                result.pop();
+                result.push( nfa::from_repetition( std::move( lhs ), t._min, t._max ) );
                 break;
-            case '(':
             case ')':
+                lhs = std::move( result.top() );
+                result.pop();
+                result.push( nfa::from_group( std::move( lhs ), t._group ) );
                 break;
             default:
-                result.push( nfa::from_character( character ) );
+                result.push( nfa::from_character( t.character, resource ) );
                 break;
             }
         };
@@ -81,13 +159,35 @@ namespace regex
     /*
      * Compile the regular expression to its finite automaton
      */
-    std::unique_ptr<regex::nfa> compile_nfa( std::basic_string_view<language::character_type> expression );
+    std::unique_ptr<regex::nfa> compile_nfa( std::basic_string_view<language::character_type> expression,
+                                             language::syntax_flag flags = language::syntax_flag::none );
     /*
      * Compile the regular expression to its finite automaton
      */
-    std::unique_ptr<regex::dfa> compile_dfa( std::basic_string_view<language::character_type> expression );
+    std::unique_ptr<regex::dfa> compile_dfa( std::basic_string_view<language::character_type> expression,
+                                             language::syntax_flag flags = language::syntax_flag::none );
+    /*
+     * Compile the regular expression to its finite automaton, keeping its groups for nfa::capture.
+     * Unlike compile_nfa the ast is not simplified, which would remove the groups
+     */
+    std::unique_ptr<regex::nfa> compile_captures( std::basic_string_view<language::character_type> expression,
+                                                  language::syntax_flag flags = language::syntax_flag::none );
+    /*
+     * Compile the regular expressions to one automaton telling which of them match, the id of each pattern being
+     * the index of its expression. An empty expression matches the empty string. Throws std::runtime_error naming
+     * the first expression which does not parse
+     */
+    std::unique_ptr<regex::pattern_set>
+    compile_patterns( const std::vector<std::basic_string<language::character_type>> &expressions,
+                      language::syntax_flag flags = language::syntax_flag::none );
     /*
      * Compile the regular expression to its finite automaton
      */
-    std::unique_ptr<regex::fa> compile( std::basic_string_view<language::character_type> expression, compile_flag flag );
+    std::unique_ptr<regex::fa> compile( std::basic_string_view<language::character_type> expression, compile_flag flag,
+                                        language::syntax_flag flags = language::syntax_flag::none );
+    /*
+     * Compile the regular expression to its finite automaton, recording the size and cost of each phase in stats
+     */
+    std::unique_ptr<regex::fa> compile( std::basic_string_view<language::character_type> expression, compile_flag flag,
+                                        language::syntax_flag flags, compile_stats &stats );
 } // namespace regex
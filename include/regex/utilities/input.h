@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "regex/language/alphabet.h"
+
+namespace regex
+{
+    /*
+     * Contents of a file or pipe read as blocks of whole records, each a view valid until the next block is read.
+     * A regular file is mapped into memory and returned as a single block, so it is never copied. Anything else,
+     * e.g. a pipe, is read in large buffers, carrying a record cut at the end of one read over to the next.
+     *
+     *      regex::input file( "server.log" );
+     *      for( auto block = file.next(); !block.empty(); block = file.next() ) { ... }
+     */
+    class input
+    {
+      public:
+        /*
+         * Size of the first buffer a pipe is read into, grown for any longer record
+         */
+        static constexpr std::size_t buffer_size = 1 << 20;
+        /*
+         * Open the file at path, or standard input if path is "-". Throws std::system_error if it cannot be opened
+         */
+        explicit input( const std::filesystem::path &path, language::character_type delimiter = '\n' );
+        explicit input( const input & ) = delete;
+        explicit input( input && ) = delete;
+        ~input();
+        /*
+         * The next block of records, ending after a delimiter unless it is the last, or empty at the end of input
+         */
+        std::basic_string_view<language::character_type> next();
+        /*
+         * Whether the file is mapped, so that every block stays valid for the lifetime of this
+         */
+        bool mapped() const;
+
+      private:
+        int descriptor_;
+        language::character_type delimiter_;
+        /*
+         * The whole file if it could be mapped, returned by the first call to next
+         */
+        void *mapping_ = nullptr;
+        std::size_t mapping_size_ = 0;
+        bool mapping_consumed_ = false;
+        /*
+         * Characters read but not yet returned, those before begin_ having been returned by the last call to next
+         */
+        std::vector<language::character_type> buffer_;
+        std::size_t begin_ = 0;
+        std::size_t end_ = 0;
+        bool exhausted_ = false;
+    };
+} // namespace regex
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "regex/automata/fa.h"
+#include "regex/language/alphabet.h"
+
+namespace regex
+{
+    /*
+     * Match the records of a stream which arrives in chunks of any size, e.g. lines read from a pipe or socket.
+     * Each record is matched in full as by fa::execute and reported with its offsets from the start of the
+     * stream. Only the state of the automata is carried between chunks, so no record is ever copied.
+     *
+     *      regex::matcher m( *automata, []( auto begin, auto end ) { ... } );
+     *      m.feed( "first li" );
+     *      m.feed( "ne\nsecond line" );
+     *      m.finish();
+     */
+    class matcher
+    {
+      public:
+        using offset_type = std::uint64_t;
+        /*
+         * Called with the offsets of the first character of a matching record and one past its last
+         */
+        using callback_type = std::function<void( offset_type begin, offset_type end )>;
+        /*
+         * Records end at each delimiter, which is not part of the record, or else the stream is a single record
+         */
+        explicit matcher( fa &automata, callback_type on_match,
+                          std::optional<language::character_type> delimiter = '\n' );
+        explicit matcher( const matcher & ) = delete;
+        explicit matcher( matcher && ) = delete;
+        /*
+         * Consume the next chunk of the stream, reporting the records it completes
+         */
+        void feed( std::basic_string_view<language::character_type> chunk );
+        /*
+         * End the stream, reporting its last record if not terminated by a delimiter, and start a new one
+         */
+        void finish();
+        /*
+         * Number of characters consumed from the current stream
+         */
+        offset_type offset() const;
+
+      private:
+        std::unique_ptr<fa::cursor> cursor_;
+        callback_type on_match_;
+        std::optional<language::character_type> delimiter_;
+        offset_type offset_ = 0;
+        offset_type record_ = 0;
+        /*
+         * Whether the current record may still match, once false the rest of it is skipped
+         */
+        bool alive_ = true;
+
+        void end_record();
+    };
+} // namespace regex
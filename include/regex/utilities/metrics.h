@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <ostream>
+
+#include "regex.h"
+
+namespace regex::metrics
+{
+    /*
+     * Whether the engines count their work, set by configuring with -DREGEX_INSTRUMENT=ON. When unset every
+     * count below compiles to nothing.
+     */
+    inline constexpr bool enabled = REGEX_INSTRUMENT != 0;
+
+    enum class counter
+    {
+        /*
+         * Characters read by any engine
+         */
+        bytes,
+        /*
+         * Labelled transitions taken, one per character for deterministic engines and one per state the
+         * character moves on from for non-deterministic ones
+         */
+        transitions,
+        /*
+         * Transitions a lazy engine had to work out on first taking them, i.e. misses of its state cache
+         */
+        cache_misses,
+        /*
+         * Times a lazy engine emptied its state cache on outgrowing it
+         */
+        cache_resets
+    };
+
+    inline constexpr std::size_t counters = 4;
+    /*
+     * Buckets of the histogram of active states, bucket b counting the characters read by a non-deterministic
+     * engine while 2^b to 2^(b+1)-1 states were active, the last also counting any more
+     */
+    inline constexpr std::size_t buckets = 16;
+    /*
+     * Totals over every thread since the start of the process
+     */
+    struct snapshot
+    {
+        std::array<std::uint64_t, counters> values{};
+        std::array<std::uint64_t, buckets> active_states{};
+        /*
+         * Active states summed over every character counted by the histogram
+         */
+        std::uint64_t active_states_sum = 0;
+
+        std::uint64_t operator[]( counter c ) const
+        {
+            return values[static_cast<std::size_t>( c )];
+        }
+    };
+
+    namespace detail
+    {
+        /*
+         * Counts of one thread, written by it alone and read by collect from any thread
+         */
+        struct block
+        {
+            std::array<std::atomic<std::uint64_t>, counters> values{};
+            std::array<std::atomic<std::uint64_t>, buckets> active_states{};
+            std::atomic<std::uint64_t> active_states_sum = 0;
+
+            block();
+            ~block();
+        };
+
+        inline thread_local block local;
+
+        inline void increment( std::atomic<std::uint64_t> &value, std::uint64_t n )
+        {
+            /*
+             * Only the owning thread writes, so a relaxed load and store add without a locked instruction
+             */
+            value.store( value.load( std::memory_order_relaxed ) + n, std::memory_order_relaxed );
+        }
+    } // namespace detail
+    /*
+     * Add n to the counter of the calling thread
+     */
+    inline void add( counter c, std::uint64_t n )
+    {
+        if constexpr ( enabled )
+        {
+            detail::increment( detail::local.values[static_cast<std::size_t>( c )], n );
+        }
+    }
+    /*
+     * Active states counted by one call of an engine in locals, added to those of the thread once at its end
+     */
+    struct histogram
+    {
+        std::array<std::uint64_t, buckets> counts{};
+        std::uint64_t sum = 0;
+        /*
+         * Count a character read while states were active
+         */
+        void count( std::size_t states )
+        {
+            if constexpr ( enabled )
+            {
+                const auto bucket = states == 0 ? 0 : std::bit_width( states ) - 1;
+
+                ++counts[std::min<std::size_t>( bucket, buckets - 1 )];
+                sum += states;
+            }
+        }
+    };
+    /*
+     * Add the histogram to that of the calling thread
+     */
+    inline void add( const histogram &h )
+    {
+        if constexpr ( enabled )
+        {
+            for ( std::size_t bucket = 0; bucket < buckets; ++bucket )
+            {
+                if ( h.counts[bucket] != 0 )
+                {
+                    detail::increment( detail::local.active_states[bucket], h.counts[bucket] );
+                }
+            }
+
+            detail::increment( detail::local.active_states_sum, h.sum );
+        }
+    }
+    /*
+     * Sum the counts of every thread, live or finished
+     */
+    snapshot collect();
+    /*
+     * Write the snapshot in the Prometheus text format, each counter prefixed with prefix
+     */
+    void write( std::ostream &output, const snapshot &s, const char *prefix = "regex_" );
+} // namespace regex::metrics
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regex/automata/fa.h"
+#include "regex/automata/pattern_set.h"
+#include "regex/language/alphabet.h"
+#include "regex/utilities/input.h"
+#include "regex/utilities/thread_pool.h"
+
+namespace regex
+{
+    /*
+     * What a search reports
+     */
+    enum class search_mode
+    {
+        /*
+         * Every matching line
+         */
+        lines,
+        /*
+         * The number of matching lines of each file
+         */
+        count,
+        /*
+         * The path of each file with a matching line, reading no further than its first
+         */
+        files,
+        /*
+         * Nothing, stopping at the first matching line of any file
+         */
+        quiet
+    };
+
+    struct search_options
+    {
+        search_mode mode = search_mode::lines;
+        /*
+         * Stop reading each file after this many matching lines, 0 for no limit
+         */
+        std::uint64_t max_count = 0;
+        /*
+         * Threads matching lines, 1 matching them on the calling thread
+         */
+        std::size_t threads = 1;
+        /*
+         * Size above which a file is split into chunks of whole lines matched in parallel
+         */
+        std::size_t chunk_size = 8 << 20;
+        /*
+         * Prefix each line or count written with the path of its file
+         */
+        bool with_filename = false;
+    };
+    /*
+     * Search files for the lines matched by an automaton, writing them in the order of the files and of the lines
+     * within them whatever the number of threads. Work is split into chunks of whole lines, each matched into a
+     * buffer of its own by a thread pool while the calling thread writes the buffers in order, so only a bounded
+     * window of chunks is ever held in memory.
+     *
+     *      regex::searcher s( *automata, std::cout, { .threads = 8 } );
+     *      s.search( { "server.log", "archive/" }, std::cerr );
+     */
+    class searcher
+    {
+      public:
+        explicit searcher( fa &automata, std::ostream &output, search_options options = search_options() );
+        /*
+         * Search for the lines matched by any of the patterns, prefixing each line written with the numbers,
+         * counting from 1, of the patterns matching it, e.g. "2,5:line"
+         */
+        explicit searcher( pattern_set &patterns, std::ostream &output, search_options options = search_options() );
+        explicit searcher( const searcher & ) = delete;
+        explicit searcher( searcher && ) = delete;
+        /*
+         * Search each target, recursing into directories, or standard input for "-". Returns false if any
+         * target could not be read, writing why to errors in its place in the output
+         */
+        bool search( const std::vector<std::filesystem::path> &targets, std::ostream &errors );
+        /*
+         * Number of matching lines reported, i.e. at most max_count per file and the first alone for
+         * search_mode::files or search_mode::quiet
+         */
+        std::uint64_t matches() const;
+        /*
+         * Characters and lines read by the automaton, which stops early for the modes that can
+         */
+        std::uint64_t bytes() const;
+        std::uint64_t lines() const;
+
+      private:
+        /*
+         * Matches of a file, shared by its chunks
+         */
+        struct file
+        {
+            std::filesystem::path path;
+            /*
+             * Whether any chunk has found a match, so that later chunks can stop for search_mode::files
+             */
+            std::atomic<bool> found = false;
+            /*
+             * Matching lines reported by the chunks written so far
+             */
+            std::uint64_t reported = 0;
+        };
+        /*
+         * The lines of a chunk matched by one task, written once done and every earlier chunk has been
+         */
+        struct chunk
+        {
+            std::basic_string_view<language::character_type> lines;
+            std::shared_ptr<file> source_file;
+            /*
+             * Whether this follows the last chunk of its file, writing what is reported per file
+             */
+            bool summary = false;
+            /*
+             * Keeps the lines alive, mapped by the input or copied from a pipe
+             */
+            std::shared_ptr<input> source;
+            std::shared_ptr<const std::basic_string<language::character_type>> copy;
+
+            std::string output;
+            std::string error;
+            std::uint64_t matches = 0;
+            /*
+             * Characters and lines matched before the chunk finished or was cut short
+             */
+            std::uint64_t bytes_read = 0;
+            std::uint64_t lines_read = 0;
+            bool done = false;
+        };
+
+        fa &automata_;
+        pattern_set *patterns_ = nullptr;
+        std::ostream &output_;
+        std::ostream *errors_ = nullptr;
+        search_options options_;
+        std::deque<std::shared_ptr<chunk>> window_;
+        /*
+         * A cursor for each thread matching, taken by a chunk while it is matched so that the states a lazy
+         * automaton builds carry over to the next chunk and file. Guarded by mutex_
+         */
+        std::vector<std::unique_ptr<fa::cursor>> cursors_;
+        std::mutex mutex_;
+        std::condition_variable done_;
+        std::uint64_t matches_ = 0;
+        std::uint64_t bytes_ = 0;
+        std::uint64_t lines_ = 0;
+        bool failed_ = false;
+        /*
+         * Set by the first match of search_mode::quiet, ending the whole search
+         */
+        std::atomic<bool> stopped_ = false;
+        /*
+         * Declared last so as to be destroyed first, joining the threads before what their tasks use goes
+         */
+        std::unique_ptr<thread_pool> pool_;
+
+        void search_file( const std::filesystem::path &path );
+        /*
+         * Whether the rest of a file can be skipped, its answer being known
+         */
+        bool finished( const file &f ) const;
+        void dispatch( std::shared_ptr<chunk> c );
+        void fail( const std::string &error );
+        /*
+         * Write the finished chunks at the front of the window, waiting until no more than keep remain
+         */
+        void flush( std::size_t keep );
+        void write( chunk &c );
+        void match( chunk &c );
+    };
+} // namespace regex
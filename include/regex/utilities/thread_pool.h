@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace regex
+{
+    /*
+     * Fixed set of threads running submitted tasks. Tasks are dealt round robin to a queue per thread, each thread
+     * taking tasks from the front of its own queue and, once that is empty, stealing from the back of the others,
+     * so uneven tasks keep every thread busy. Every submit and take still counts the pending tasks under one
+     * shared lock, which idle threads wait on, so the pool suits tasks long enough for that lock not to matter,
+     * such as the chunks of a search.
+     */
+    class thread_pool
+    {
+      public:
+        using task_type = std::function<void()>;
+
+        explicit thread_pool( std::size_t threads );
+        explicit thread_pool( const thread_pool & ) = delete;
+        explicit thread_pool( thread_pool && ) = delete;
+        /*
+         * Run every task already submitted, then join the threads
+         */
+        ~thread_pool();
+        /*
+         * Queue task to be run by some thread. Tasks must not throw
+         */
+        void submit( task_type task );
+        /*
+         * Number of threads
+         */
+        std::size_t size() const;
+
+      private:
+        struct queue
+        {
+            std::mutex mutex;
+            std::deque<task_type> tasks;
+        };
+
+        std::vector<std::unique_ptr<queue>> queues_;
+        std::vector<std::thread> threads_;
+        /*
+         * Queue given the next task submitted
+         */
+        std::atomic<std::size_t> next_ = 0;
+        /*
+         * Tasks submitted but not yet taken, guarded by mutex_ for threads waiting on wake_
+         */
+        std::size_t pending_ = 0;
+        bool stopping_ = false;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+
+        void work( std::size_t index );
+        bool take( std::size_t index, task_type &task );
+    };
+} // namespace regex
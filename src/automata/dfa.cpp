@@ -5,6 +5,7 @@
 
 #include "regex/automata/dfa.h"
 #include "regex/state/dstate.h"
+#include "regex/utilities/metrics.h"
 
 namespace regex
 {
@@ -19,4 +20,78 @@ namespace regex
     {
         return regex::state::execute( input_, outputs_, target );
     }
+
+    namespace
+    {
+        class dcursor : public fa::cursor
+        {
+          public:
+            explicit dcursor( const state::dstate *input, const state::dstate::group_type &outputs )
+                : input_( input ), outputs_( outputs ), state_( input )
+            {
+            }
+
+            void reset() override
+            {
+                state_ = input_;
+            }
+
+            bool advance( std::basic_string_view<language::character_type> target ) override
+            {
+                std::uint64_t read = 0;
+
+                for ( const auto character : target )
+                {
+                    if ( !state_ )
+                    {
+                        break;
+                    }
+
+                    state_ = state_->next( static_cast<state::dstate::transition_label_type>( character ) );
+                    ++read;
+                }
+
+                metrics::add( metrics::counter::bytes, read );
+                metrics::add( metrics::counter::transitions, state_ || read == 0 ? read : read - 1 );
+
+                return state_ != nullptr;
+            }
+
+            bool accepted() const override
+            {
+                return state_ && outputs_.contains( state_ );
+            }
+
+          private:
+            const state::dstate *input_;
+            const state::dstate::group_type &outputs_;
+            const state::dstate *state_;
+        };
+    } // namespace
+
+    std::unique_ptr<fa::cursor> dfa::make_cursor()
+    {
+        return std::make_unique<dcursor>( input_, outputs_ );
+    }
+
+    std::size_t dfa::size() const
+    {
+        return states_.size();
+    }
+
+    std::size_t dfa::bytes() const
+    {
+        /*
+         * Each set element is a tree node of three links and a colour besides its value
+         */
+        constexpr std::size_t node = 4 * sizeof( void * );
+        std::size_t result = ( states_.size() + outputs_.size() ) * ( node + sizeof( void * ) );
+
+        for ( const auto &st : states_ )
+        {
+            result += sizeof( state::dstate ) + st->transitions().capacity() * sizeof( state::dstate::transition );
+        }
+
+        return result;
+    }
 } // namespace regex
\ No newline at end of file
@@ -1,241 +1,641 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <deque>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "regex/automata/nfa.h"
 #include "regex/language/ast.h"
+#include "regex/language/utf8.h"
+#include "regex/memory/arena.h"
 
 namespace regex
 {
-    nfa::nfa( state::nstate *input, state::nstate *output, std::set<std::unique_ptr<state::nstate>> states )
-        : states_( std::move( states ) ), input_( input ), output_( output )
+    nfa::nfa( state::ngraph graph, state::state_id input, state::state_id output )
+        : graph_( std::move( graph ) ), input_( input ), output_( output )
     {
     }
 
-    std::unique_ptr<nfa> nfa::from_character( language::character_type character )
+    nfa::nfa( const nfa &other )
+        : graph_( other.graph_ ), input_( other.input_ ), output_( other.output_ ), groups_( other.groups_ ),
+          onepass_( other.onepass_ ), onepass_built_( other.onepass_built_ )
     {
-        auto input = std::make_unique<state::nstate>();
-        auto output = std::make_unique<state::nstate>();
-
-        input->connect( output.get(), character );
-
-        auto i = input.get();
-        auto o = output.get();
-
-        std::set<std::unique_ptr<state::nstate>> states;
-        states.insert( std::move( input ) );
-        states.insert( std::move( output ) );
-
-        return std::make_unique<nfa>( i, o, std::move( states ) );
     }
 
-    static state::nstate *copy( const state::nstate *src,
-                                std::map<const state::nstate *, std::unique_ptr<state::nstate>> &visited )
+    void nfa::merge( nfa &lhs, nfa &rhs )
     {
-        const auto preexisting = visited.find( src );
+        assert( lhs.graph_.resource()->is_equal( *rhs.graph_.resource() ) );
 
-        if ( preexisting != std::cend( visited ) )
+        if ( lhs.graph_.size() < rhs.graph_.size() )
         {
-            return preexisting->second.get();
+            std::swap( lhs.graph_, rhs.graph_ );
+
+            const auto offset = lhs.graph_.splice( rhs.graph_ );
+
+            lhs.input_ += offset;
+            lhs.output_ += offset;
         }
         else
         {
-            auto new_state = visited.insert( { src, std::make_unique<state::nstate>() } ).first->second.get();
+            const auto offset = lhs.graph_.splice( rhs.graph_ );
 
-            for ( const auto &label_to_states : src->transitions() )
-            {
-                for ( const auto &st : label_to_states.second )
-                {
-                    new_state->connect( copy( st, visited ), label_to_states.first );
-                }
-            }
-
-            return new_state;
+            rhs.input_ += offset;
+            rhs.output_ += offset;
         }
+
+        rhs.graph_ = state::ngraph( rhs.graph_.resource() );
     }
 
-    nfa::nfa( const nfa &other )
+    std::unique_ptr<nfa> nfa::from_character( language::character_type character, std::pmr::memory_resource *resource )
     {
-        std::map<const state::nstate *, std::unique_ptr<state::nstate>> visited;
+        state::ngraph graph( resource );
 
-        input_ = copy( other.input_, visited );
-        output_ = visited.find( other.output_ )->second.get();
+        const auto input = graph.add_state();
+        const auto output = graph.add_state();
 
-        std::transform( std::begin( visited ), std::end( visited ), std::inserter( states_, std::end( states_ ) ),
-                        []( auto &st ) { return std::move( st.second ); } );
+        graph.connect( input, output, static_cast<state::nstate::transition_label_type>( character ),
+                       static_cast<state::nstate::transition_label_type>( character ) );
+
+        return std::make_unique<nfa>( std::move( graph ), input, output );
+    }
+
+    std::unique_ptr<nfa> nfa::from_epsilon( std::pmr::memory_resource *resource )
+    {
+        state::ngraph graph( resource );
+
+        const auto input = graph.add_state();
+        const auto output = graph.add_state();
+
+        graph.connect( input, output );
+
+        return std::make_unique<nfa>( std::move( graph ), input, output );
     }
 
-    std::unique_ptr<nfa> nfa::from_epsilon()
+    std::unique_ptr<nfa> nfa::from_any( std::pmr::memory_resource *resource )
     {
-        return from_character( state::nstate::epsilon );
+        return from_class( language::character_class( 0, language::character_class::byte_max ), resource );
     }
 
-    std::unique_ptr<nfa> nfa::from_any()
+    std::unique_ptr<nfa> nfa::from_class( const language::character_class &characters,
+                                          std::pmr::memory_resource *resource )
     {
-        auto input = std::make_unique<state::nstate>();
-        auto output = std::make_unique<state::nstate>();
+        state::ngraph graph( resource );
 
-        for ( const auto character : language::alphabet )
+        const auto input = graph.add_state();
+        const auto output = graph.add_state();
+
+        for ( const auto &range : characters.ranges() )
         {
-            input->connect( output.get(), character );
+            if ( range.lower > language::character_class::byte_max )
+            {
+                break;
+            }
+
+            graph.connect( input, output, static_cast<state::nstate::transition_label_type>( range.lower ),
+                           static_cast<state::nstate::transition_label_type>(
+                               std::min( range.upper, language::character_class::byte_max ) ) );
         }
 
-        auto i = input.get();
-        auto o = output.get();
+        return std::make_unique<nfa>( std::move( graph ), input, output );
+    }
 
-        std::set<std::unique_ptr<state::nstate>> states;
-        states.insert( std::move( input ) );
-        states.insert( std::move( output ) );
+    std::unique_ptr<nfa> nfa::from_utf8_class( const language::character_class &characters,
+                                               std::pmr::memory_resource *resource )
+    {
+        state::ngraph graph( resource );
+
+        const auto input = graph.add_state();
+        const auto output = graph.add_state();
+        /*
+         * The states reached by the leading byte ranges of the previous sequence, which are sorted so that
+         * sequences sharing leading ranges are adjacent
+         */
+        std::array<state::state_id, 4> reached{ input };
+        const language::utf8::sequence *previous = nullptr;
+
+        for ( const auto &sequence : language::utf8::sequences( characters ) )
+        {
+            std::size_t shared = 0;
+
+            while ( previous && shared + 1 < sequence.size && shared + 1 < previous->size &&
+                    sequence.bytes[shared] == previous->bytes[shared] )
+            {
+                ++shared;
+            }
+
+            for ( std::size_t i = shared; i < sequence.size; ++i )
+            {
+                const auto target = i + 1 == sequence.size ? output : graph.add_state();
+
+                graph.connect( reached[i], target,
+                               static_cast<state::nstate::transition_label_type>( sequence.bytes[i].lower ),
+                               static_cast<state::nstate::transition_label_type>( sequence.bytes[i].upper ) );
+
+                if ( i + 1 < reached.size() )
+                {
+                    reached[i + 1] = target;
+                }
+            }
+
+            previous = &sequence;
+        }
 
-        return std::make_unique<nfa>( i, o, std::move( states ) );
+        return std::make_unique<nfa>( std::move( graph ), input, output );
     }
 
     std::unique_ptr<nfa> nfa::from_concatenation( std::unique_ptr<nfa> lhs, std::unique_ptr<nfa> rhs )
     {
-        lhs->output_->connect( rhs->input_, state::nstate::epsilon );
+        merge( *lhs, *rhs );
+
+        lhs->graph_.connect( lhs->output_, rhs->input_ );
         lhs->output_ = rhs->output_;
-        lhs->states_.merge( std::move( rhs->states_ ) );
+        lhs->groups_ = std::max( lhs->groups_, rhs->groups_ );
 
         return lhs;
     }
 
     std::unique_ptr<nfa> nfa::from_alternation( std::unique_ptr<nfa> lhs, std::unique_ptr<nfa> rhs )
     {
-        std::unique_ptr<state::nstate> input = std::make_unique<state::nstate>();
-        std::unique_ptr<state::nstate> output = std::make_unique<state::nstate>();
-
-        input->connect( lhs->input_, state::nstate::epsilon );
-        input->connect( rhs->input_, state::nstate::epsilon );
-        lhs->output_->connect( output.get(), state::nstate::epsilon );
-        rhs->output_->connect( output.get(), state::nstate::epsilon );
+        merge( *lhs, *rhs );
 
-        lhs->states_.merge( std::move( rhs->states_ ) );
+        const auto input = lhs->graph_.add_state();
+        const auto output = lhs->graph_.add_state();
 
-        lhs->input_ = input.get();
-        lhs->output_ = output.get();
+        lhs->graph_.connect( input, lhs->input_ );
+        lhs->graph_.connect( input, rhs->input_ );
+        lhs->graph_.connect( lhs->output_, output );
+        lhs->graph_.connect( rhs->output_, output );
 
-        lhs->states_.insert( std::move( input ) );
-        lhs->states_.insert( std::move( output ) );
+        lhs->input_ = input;
+        lhs->output_ = output;
+        lhs->groups_ = std::max( lhs->groups_, rhs->groups_ );
 
         return lhs;
     }
 
     std::unique_ptr<nfa> nfa::from_kleene( std::unique_ptr<nfa> expression )
     {
-        auto input = std::make_unique<state::nstate>();
-        auto output = std::make_unique<state::nstate>();
+        const auto input = expression->graph_.add_state();
+        const auto output = expression->graph_.add_state();
+
+        expression->graph_.connect( input, expression->input_ );
+        expression->graph_.connect( input, output );
+        expression->graph_.connect( expression->output_, output );
+        expression->graph_.connect( output, expression->input_ );
+
+        expression->input_ = input;
+        expression->output_ = output;
+
+        return expression;
+    }
+
+    std::unique_ptr<nfa> nfa::from_one_or_more( std::unique_ptr<nfa> expression )
+    {
+        const auto output = expression->graph_.add_state();
+
+        expression->graph_.connect( expression->output_, output );
+        expression->graph_.connect( output, expression->input_ );
+
+        expression->output_ = output;
+
+        return expression;
+    }
+
+    std::unique_ptr<nfa> nfa::from_group( std::unique_ptr<nfa> expression, std::uint32_t group )
+    {
+        const auto input = expression->graph_.add_state();
+        const auto output = expression->graph_.add_state();
+
+        expression->graph_.connect_tagged( input, expression->input_, 2 * group );
+        expression->graph_.connect_tagged( expression->output_, output, 2 * group + 1 );
+
+        expression->input_ = input;
+        expression->output_ = output;
+        expression->groups_ = std::max( expression->groups_, group + 1 );
+
+        return expression;
+    }
+
+    std::unique_ptr<nfa> nfa::from_repetition( std::unique_ptr<nfa> expression, std::uint32_t min,
+                                               std::uint32_t max )
+    {
+        if ( max == 0 )
+        {
+            auto empty = from_epsilon( expression->graph_.resource() );
+            empty->groups_ = expression->groups_;
 
-        input->connect( expression->input_, state::nstate::epsilon );
-        input->connect( output.get(), state::nstate::epsilon );
-        expression->output_->connect( output.get(), state::nstate::epsilon );
-        output->connect( expression->input_, state::nstate::epsilon );
+            return empty;
+        }
 
-        expression->input_ = input.get();
-        expression->output_ = output.get();
+        if ( min == 0 && max == language::repetition_unbounded )
+        {
+            return from_kleene( std::move( expression ) );
+        }
 
-        expression->states_.insert( std::move( input ) );
-        expression->states_.insert( std::move( output ) );
+        const std::size_t copies = max == language::repetition_unbounded ? min + 1u : max;
+
+        if ( expression->graph_.size() * copies > state_limit )
+        {
+            throw std::runtime_error( "Repetition expands to more than " + std::to_string( state_limit ) +
+                                      " states" );
+        }
+
+        const state::ngraph prototype = std::move( expression->graph_ );
+        auto &graph = expression->graph_;
+
+        graph = state::ngraph( prototype.resource() );
+
+        const auto input = graph.add_state();
+        auto output = input;
+        auto repeat_input = input;
+
+        auto repeat = [&]() {
+            const auto offset = graph.splice( prototype );
+
+            repeat_input = expression->input_ + offset;
+            graph.connect( output, repeat_input );
+            output = expression->output_ + offset;
+        };
+
+        for ( std::uint32_t i = 0; i < min; ++i )
+        {
+            repeat();
+        }
+
+        if ( max == language::repetition_unbounded )
+        {
+            const auto loop = graph.add_state();
+
+            graph.connect( output, loop );
+            graph.connect( loop, repeat_input );
+
+            output = loop;
+        }
+        else if ( max > min )
+        {
+            const auto skip = graph.add_state();
+
+            for ( std::uint32_t i = min; i < max; ++i )
+            {
+                const auto optional = output;
+
+                repeat();
+                graph.connect( optional, skip );
+            }
+
+            graph.connect( output, skip );
+
+            output = skip;
+        }
+
+        expression->input_ = input;
+        expression->output_ = output;
 
         return expression;
     }
 
     bool nfa::execute( std::basic_string_view<language::character_type> target )
     {
-        return regex::state::execute( input_, output_, target );
+        graph_.compact();
+
+        if ( simulation_ && simulation_->simulates( graph_, input_, output_ ) )
+        {
+            simulation_->reset();
+        }
+        else
+        {
+            simulation_ = std::make_unique<state::nsimulation>( graph_, input_, output_ );
+        }
+
+        return simulation_->advance( target ) && simulation_->accepted();
+    }
+
+    std::optional<std::vector<submatch>> nfa::capture( std::basic_string_view<language::character_type> target )
+    {
+        graph_.compact();
+
+        const std::size_t slots = 2 * groups_;
+
+        if ( !onepass_built_ )
+        {
+            if ( auto table = state::onepass::build( graph_, input_, output_, slots ) )
+            {
+                onepass_ = std::make_shared<const state::onepass>( std::move( *table ) );
+            }
+
+            onepass_built_ = true;
+        }
+
+        auto positions = onepass_ ? onepass_->capture( target )
+                                  : state::capture( graph_, input_, output_, slots, target );
+
+        if ( !positions )
+        {
+            return std::nullopt;
+        }
+
+        std::vector<submatch> result( groups_ );
+
+        ( *positions )[0] = 0;
+        ( *positions )[1] = target.size();
+
+        for ( std::uint32_t group = 0; group < groups_; ++group )
+        {
+            const auto begin = ( *positions )[2 * group];
+            const auto end = ( *positions )[2 * group + 1];
+
+            if ( begin != submatch::npos && end != submatch::npos )
+            {
+                result[group] = { begin, end };
+            }
+        }
+
+        return result;
+    }
+
+    namespace
+    {
+        class ncursor : public fa::cursor
+        {
+          public:
+            explicit ncursor( const state::ngraph &graph, state::state_id input, state::state_id output )
+                : simulation_( graph, input, output )
+            {
+            }
+
+            void reset() override
+            {
+                simulation_.reset();
+            }
+
+            bool advance( std::basic_string_view<language::character_type> target ) override
+            {
+                return simulation_.advance( target );
+            }
+
+            bool accepted() const override
+            {
+                return simulation_.accepted();
+            }
+
+          private:
+            state::nsimulation simulation_;
+        };
+    } // namespace
+
+    std::unique_ptr<fa::cursor> nfa::make_cursor()
+    {
+        graph_.compact();
+
+        return std::make_unique<ncursor>( graph_, input_, output_ );
     }
 
-    static state::nstate::group_type epsilon_closure( const state::nstate *start )
+    namespace
     {
-        state::nstate::group_type closure;
+        /*
+         * Sorted, duplicate free set of non-deterministic states identifying a deterministic state
+         */
+        using state_set = std::pmr::vector<state::state_id>;
+
+        struct state_set_hash
+        {
+            std::size_t operator()( const state_set &states ) const noexcept
+            {
+                std::size_t seed = states.size();
 
-        auto fetch = [&closure]( const state::nstate *start, auto fetch ) {
-            const bool did_not_exist = closure.insert( start ).second;
-            if ( !did_not_exist )
+                for ( const auto st : states )
+                {
+                    seed ^= std::hash<state::state_id>{}( st ) + 0x9e3779b97f4a7c15ULL + ( seed << 6 ) + ( seed >> 2 );
+                }
+
+                return seed;
+            }
+        };
+
+        /*
+         * Memoised epsilon closures, computed at most once per non-deterministic state
+         */
+        class epsilon_closures
+        {
+          public:
+            explicit epsilon_closures( const state::ngraph &graph, std::pmr::memory_resource *resource )
+                : graph_( graph )
+                , closures_( graph.size(), resource )
+                , computed_( graph.size(), false, resource )
+                , seen_( graph.size(), 0, resource )
+                , pending_( resource )
             {
-                return;
             }
-            else
+
+            const state_set &operator()( state::state_id start )
+            {
+                if ( !computed_[start] )
+                {
+                    closures_[start] = compute( start );
+                    computed_[start] = true;
+                }
+
+                return closures_[start];
+            }
+
+          private:
+            const state::ngraph &graph_;
+            std::pmr::vector<state_set> closures_;
+            std::pmr::vector<bool> computed_;
+            /*
+             * Generation in which each state was last reached, avoiding a clear per closure
+             */
+            std::pmr::vector<std::uint32_t> seen_;
+            std::uint32_t generation_ = 0;
+            std::pmr::vector<state::state_id> pending_;
+
+            state_set compute( state::state_id start )
             {
-                const auto next_epsilons = start->transitions().find( state::nstate::epsilon );
-                if ( next_epsilons != std::cend( start->transitions() ) )
+                ++generation_;
+
+                state_set closure( 1, start, closures_.get_allocator() );
+                seen_[start] = generation_;
+                pending_.push_back( start );
+
+                while ( !pending_.empty() )
                 {
-                    for ( const auto next_epsilon : next_epsilons->second )
+                    const auto current = pending_.back();
+                    pending_.pop_back();
+
+                    for ( const auto &e : graph_.epsilons( current ) )
                     {
-                        fetch( next_epsilon, fetch );
+                        if ( seen_[e.target] != generation_ )
+                        {
+                            seen_[e.target] = generation_;
+                            closure.push_back( e.target );
+                            pending_.push_back( e.target );
+                        }
                     }
                 }
+
+                std::sort( std::begin( closure ), std::end( closure ) );
+
+                return closure;
             }
         };
+    } // namespace
+
+    std::size_t nfa::size() const
+    {
+        return graph_.size();
+    }
 
-        fetch( start, fetch );
+    std::size_t nfa::transitions() const
+    {
+        return graph_.transitions().size() + graph_.epsilons().size();
+    }
 
-        return closure;
+    std::size_t nfa::bytes() const
+    {
+        return graph_.bytes();
     }
 
-    static state::dstate *subset_construction(
-        const state::nstate::group_type &start,
-        std::map<state::nstate::group_type, state::dstate *> &epsilon_closures_processing,
-        std::set<std::unique_ptr<state::dstate>> &new_deterministic_states,
-        const state::nstate *non_deterministic_output, std::set<const state::dstate *> &deterministic_outputs )
+    std::unique_ptr<dfa> nfa::to_dfa( std::pmr::memory_resource *scratch, std::size_t budget )
     {
-        state::nstate::group_type closure;
+        graph_.compact();
+
+        std::optional<memory::arena> own_scratch;
 
-        for ( const auto st : start )
+        if ( !scratch )
         {
-            closure.merge( epsilon_closure( st ) );
+            scratch = &own_scratch.emplace();
         }
 
-        const auto existing_closure = epsilon_closures_processing.find( closure );
+        epsilon_closures closure_of( graph_, scratch );
+        std::pmr::unordered_map<state_set, state::dstate *, state_set_hash> deterministic_states( scratch );
+        std::set<std::unique_ptr<state::dstate>> new_deterministic_states;
+        std::set<const state::dstate *> deterministic_outputs;
+        std::queue<std::pair<const state_set *, state::dstate *>,
+                   std::pmr::deque<std::pair<const state_set *, state::dstate *>>>
+            worklist( scratch );
+
+        /*
+         * Non-deterministic states held by the sets of the deterministic states, each counting at least one
+         */
+        std::size_t held = 0;
+        /*
+         * Find the deterministic state for a set of non-deterministic states, scheduling it if it is new
+         */
+        auto intern = [&]( const state_set &closure ) {
+            const auto [existing, inserted] = deterministic_states.try_emplace( closure, nullptr );
+
+            if ( inserted )
+            {
+                held += std::max<std::size_t>( closure.size(), 1 );
 
-        if ( existing_closure != std::cend( epsilon_closures_processing ) )
+                existing->second = new_deterministic_states.insert( std::make_unique<state::dstate>() ).first->get();
+
+                if ( std::binary_search( std::cbegin( existing->first ), std::cend( existing->first ), output_ ) )
+                {
+                    deterministic_outputs.insert( existing->second );
+                }
+
+                worklist.emplace( &existing->first, existing->second );
+            }
+
+            return existing->second;
+        };
+
+        /*
+         * Split the characters into intervals which no labelled transition partially covers
+         */
+        std::array<bool, 257> boundaries{};
+        boundaries[0] = true;
+
+        for ( const auto &t : graph_.transitions() )
         {
-            return existing_closure->second;
+            boundaries[t.lower] = true;
+            boundaries[t.upper + 1] = true;
         }
 
-        auto &new_deterministic_state = *new_deterministic_states.insert( std::make_unique<state::dstate>() ).first;
-
-        epsilon_closures_processing.insert( { closure, new_deterministic_state.get() } );
+        std::array<std::uint16_t, 256> interval_of;
+        std::vector<state::nstate::transition_label_type> interval_lower;
 
-        if ( closure.contains( non_deterministic_output ) )
+        for ( std::size_t character = 0; character < interval_of.size(); ++character )
         {
-            deterministic_outputs.insert( new_deterministic_state.get() );
+            if ( boundaries[character] )
+            {
+                interval_lower.push_back( static_cast<state::nstate::transition_label_type>( character ) );
+            }
+
+            interval_of[character] = static_cast<std::uint16_t>( interval_lower.size() - 1 );
         }
 
-        std::map<language::character_type, state::nstate::group_type> new_transitions;
+        std::pmr::vector<state_set> moves( interval_lower.size(), scratch );
+        std::pmr::vector<std::uint16_t> intervals( scratch );
+        state_set closure( scratch );
 
-        for ( const auto state : closure )
+        auto dfa_input = intern( closure_of( input_ ) );
+
+        while ( !worklist.empty() && held <= budget )
         {
-            for ( auto next : state->transitions() )
+            const auto [current, deterministic_state] = worklist.front();
+            worklist.pop();
+
+            for ( const auto st : *current )
             {
-                if ( next.first != state::nstate::epsilon )
+                for ( const auto &t : graph_.transitions( st ) )
                 {
-                    new_transitions[next.first].merge( next.second );
+                    for ( auto interval = interval_of[t.lower]; interval <= interval_of[t.upper]; ++interval )
+                    {
+                        if ( moves[interval].empty() )
+                        {
+                            intervals.push_back( interval );
+                        }
+
+                        moves[interval].push_back( t.target );
+                    }
                 }
             }
-        }
 
-        for ( const auto &next : new_transitions )
-        {
-            new_deterministic_state->connect( subset_construction( next.second, epsilon_closures_processing,
-                                                                   new_deterministic_states, non_deterministic_output,
-                                                                   deterministic_outputs ),
-                                              next.first );
-        }
+            std::sort( std::begin( intervals ), std::end( intervals ) );
 
-        return new_deterministic_state.get();
-    }
+            for ( const auto interval : intervals )
+            {
+                auto &move = moves[interval];
 
-    std::unique_ptr<dfa> nfa::to_dfa(  )
-    {
-        std::map<state::nstate::group_type, state::dstate *> epsilon_closures_processed;
-        std::set<std::unique_ptr<state::dstate>> new_deterministic_states;
-        std::set<const state::dstate *> deterministic_outputs;
+                closure.clear();
+
+                for ( const auto st : move )
+                {
+                    const auto &reachable = closure_of( st );
+                    closure.insert( std::end( closure ), std::cbegin( reachable ), std::cend( reachable ) );
+                }
+
+                std::sort( std::begin( closure ), std::end( closure ) );
+                closure.erase( std::unique( std::begin( closure ), std::end( closure ) ), std::end( closure ) );
+
+                const auto upper = interval + 1u < interval_lower.size() ? interval_lower[interval + 1] - 1 : 0xFF;
 
-        auto dfa_input = subset_construction( state::nstate::group_type{ input_ }, epsilon_closures_processed,
-                                              new_deterministic_states, output_, deterministic_outputs );
+                deterministic_state->connect( intern( closure ), interval_lower[interval],
+                                              static_cast<state::dstate::transition_label_type>( upper ) );
 
-        auto a = std::make_unique<dfa>( dfa_input, std::move( deterministic_outputs ),
-                                        std::move( new_deterministic_states ) );
+                move.clear();
+            }
+
+            intervals.clear();
+        }
+
+        if ( held > budget )
+        {
+            return nullptr;
+        }
 
-        return a;
+        return std::make_unique<dfa>( dfa_input, std::move( deterministic_outputs ),
+                                      std::move( new_deterministic_states ) );
     }
 } // namespace regex
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "regex/automata/pattern_set.h"
+#include "regex/utilities/metrics.h"
+
+namespace regex
+{
+    pattern_set::pattern_set( const std::vector<std::unique_ptr<nfa>> &patterns )
+        : size_( patterns.size() )
+    {
+        std::vector<std::pair<state::state_id, pattern_id>> outputs;
+
+        input_ = graph_.add_state();
+
+        for ( pattern_id id = 0; id < patterns.size(); ++id )
+        {
+            const auto &pattern = *patterns[id];
+            const auto offset = graph_.splice( pattern.graph_ );
+
+            graph_.connect( input_, pattern.input_ + offset );
+            outputs.emplace_back( pattern.output_ + offset, id );
+        }
+
+        graph_.compact();
+        accepts_.assign( graph_.size(), none );
+
+        for ( const auto &[output, id] : outputs )
+        {
+            accepts_[output] = id;
+        }
+    }
+
+    namespace
+    {
+        /*
+         * Sorted, duplicate free set of non-deterministic states identifying a deterministic state
+         */
+        using state_set = std::vector<state::state_id>;
+
+        struct state_set_hash
+        {
+            std::size_t operator()( const state_set &states ) const noexcept
+            {
+                std::size_t seed = states.size();
+
+                for ( const auto st : states )
+                {
+                    seed ^= std::hash<state::state_id>{}( st ) + 0x9e3779b97f4a7c15ULL + ( seed << 6 ) + ( seed >> 2 );
+                }
+
+                return seed;
+            }
+        };
+
+        class lazy_cursor : public pattern_set::cursor
+        {
+          public:
+            explicit lazy_cursor( const state::ngraph &graph, state::state_id input,
+                                  const std::vector<pattern_set::pattern_id> &accepts )
+                : graph_( graph ), accepts_( accepts ), reached_( graph.size() )
+            {
+                add_closure( input );
+                input_states_.assign( std::cbegin( reached_.states() ), std::cend( reached_.states() ) );
+                std::sort( std::begin( input_states_ ), std::end( input_states_ ) );
+                start_over();
+            }
+
+            void reset() override
+            {
+                state_ = input;
+            }
+
+            bool advance( std::basic_string_view<language::character_type> target ) override
+            {
+                std::uint64_t read = 0;
+
+                for ( const auto character : target )
+                {
+                    const auto label = static_cast<state::nstate::transition_label_type>( character );
+                    const auto next = states_[state_].next[label];
+
+                    state_ = next != unknown ? next : step( label );
+                    ++read;
+
+                    if ( state_ == dead )
+                    {
+                        break;
+                    }
+                }
+
+                metrics::add( metrics::counter::bytes, read );
+                metrics::add( metrics::counter::transitions, state_ != dead || read == 0 ? read : read - 1 );
+
+                return state_ != dead;
+            }
+
+            bool accepted() const override
+            {
+                return !states_[state_].patterns.empty();
+            }
+
+            std::span<const pattern_set::pattern_id> patterns() const override
+            {
+                return states_[state_].patterns;
+            }
+
+          private:
+            static constexpr std::uint32_t unknown = std::numeric_limits<std::uint32_t>::max();
+            /*
+             * The states every start over begins with, those of no and of empty input
+             */
+            static constexpr std::uint32_t dead = 0;
+            static constexpr std::uint32_t input = 1;
+
+            struct dstate
+            {
+                /*
+                 * State reached by each character, or unknown until it is first read here
+                 */
+                std::array<std::uint32_t, 256> next;
+                const state_set *states;
+                std::vector<pattern_set::pattern_id> patterns;
+            };
+
+            const state::ngraph &graph_;
+            const std::vector<pattern_set::pattern_id> &accepts_;
+            std::unordered_map<state_set, std::uint32_t, state_set_hash> index_;
+            std::vector<dstate> states_;
+            std::size_t bytes_ = 0;
+            state_set input_states_;
+            std::uint32_t state_ = input;
+            state::sparse_set reached_;
+            std::vector<state::state_id> pending_;
+
+            void add_closure( state::state_id st )
+            {
+                if ( !reached_.insert( st ) )
+                {
+                    return;
+                }
+
+                pending_.push_back( st );
+
+                while ( !pending_.empty() )
+                {
+                    const auto current = pending_.back();
+                    pending_.pop_back();
+
+                    for ( const auto &e : graph_.epsilons( current ) )
+                    {
+                        if ( reached_.insert( e.target ) )
+                        {
+                            pending_.push_back( e.target );
+                        }
+                    }
+                }
+            }
+            /*
+             * Forget every deterministic state but the dead and input states
+             */
+            void start_over()
+            {
+                states_.clear();
+                index_.clear();
+                bytes_ = 0;
+
+                intern( state_set() );
+                states_[dead].next.fill( dead );
+                intern( input_states_ );
+            }
+
+            std::uint32_t intern( state_set states )
+            {
+                const auto [existing, inserted] =
+                    index_.try_emplace( std::move( states ), static_cast<std::uint32_t>( states_.size() ) );
+
+                if ( inserted )
+                {
+                    auto &d = states_.emplace_back();
+
+                    d.next.fill( unknown );
+                    d.states = &existing->first;
+
+                    for ( const auto st : existing->first )
+                    {
+                        if ( accepts_[st] != pattern_set::none )
+                        {
+                            d.patterns.push_back( accepts_[st] );
+                        }
+                    }
+
+                    std::sort( std::begin( d.patterns ), std::end( d.patterns ) );
+                    bytes_ += sizeof( dstate ) + existing->first.size() * sizeof( state::state_id ) +
+                              d.patterns.size() * sizeof( pattern_set::pattern_id );
+                }
+
+                return existing->second;
+            }
+            /*
+             * Add the state reached from the current one by label, remembering the transition unless the cache
+             * had to start over to make room for it
+             */
+            std::uint32_t step( state::nstate::transition_label_type label )
+            {
+                metrics::add( metrics::counter::cache_misses, 1 );
+                reached_.clear();
+
+                for ( const auto st : *states_[state_].states )
+                {
+                    for ( const auto &t : graph_.transitions( st ) )
+                    {
+                        if ( t.lower <= label && label <= t.upper )
+                        {
+                            add_closure( t.target );
+                        }
+                    }
+                }
+
+                state_set next( std::cbegin( reached_.states() ), std::cend( reached_.states() ) );
+                std::sort( std::begin( next ), std::end( next ) );
+
+                if ( bytes_ > pattern_set::cache_limit )
+                {
+                    metrics::add( metrics::counter::cache_resets, 1 );
+                    start_over();
+                    return intern( std::move( next ) );
+                }
+
+                const auto reached = intern( std::move( next ) );
+                states_[state_].next[label] = reached;
+
+                return reached;
+            }
+        };
+    } // namespace
+
+    pattern_set::cursor &pattern_set::reset()
+    {
+        if ( !cursor_ )
+        {
+            cursor_ = make_pattern_cursor();
+        }
+
+        cursor_->reset();
+
+        return *cursor_;
+    }
+
+    bool pattern_set::execute( std::basic_string_view<language::character_type> target )
+    {
+        auto &c = reset();
+
+        return c.advance( target ) && c.accepted();
+    }
+
+    std::vector<pattern_set::pattern_id> pattern_set::matches( std::basic_string_view<language::character_type> target )
+    {
+        auto &c = reset();
+
+        if ( !c.advance( target ) )
+        {
+            return {};
+        }
+
+        const auto patterns = c.patterns();
+
+        return { std::cbegin( patterns ), std::cend( patterns ) };
+    }
+
+    std::unique_ptr<fa::cursor> pattern_set::make_cursor()
+    {
+        return make_pattern_cursor();
+    }
+
+    std::unique_ptr<pattern_set::cursor> pattern_set::make_pattern_cursor() const
+    {
+        return std::make_unique<lazy_cursor>( graph_, input_, accepts_ );
+    }
+
+    std::size_t pattern_set::size() const
+    {
+        return size_;
+    }
+} // namespace regex
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <filesystem>
+#include <iomanip>
 #include <sstream>
+#include <typeinfo>
 
 #include "regex/utilities/cmdline.h"
 
@@ -15,9 +18,56 @@ namespace regex
         {
         }
 
-        static std::any parse_string( const std::string &val )
+        static std::any parse_value( const std::string &val, cmdline::type t )
         {
-            return std::any( val );
+            try
+            {
+                std::size_t parsed = 0;
+                std::any result;
+
+                switch ( t )
+                {
+                case cmdline::type::integral:
+                    result = std::stoi( val, &parsed );
+                    break;
+                case cmdline::type::floating:
+                    result = std::stod( val, &parsed );
+                    break;
+                case cmdline::type::boolean:
+                    result = val == "true" || val == "1";
+                    parsed = val.size();
+                    break;
+                case cmdline::type::string:
+                    return std::any( val );
+                }
+
+                if ( parsed == val.size() )
+                {
+                    return result;
+                }
+            }
+            catch ( const std::logic_error & )
+            {
+            }
+
+            throw exception( "Invalid value " + val );
+        }
+
+        static std::any empty_value( cmdline::type t )
+        {
+            switch ( t )
+            {
+            case cmdline::type::integral:
+                return std::any( 0 );
+            case cmdline::type::floating:
+                return std::any( 0.0 );
+            case cmdline::type::boolean:
+                return std::any( false );
+            case cmdline::type::string:
+                break;
+            }
+
+            return std::any( std::string() );
         }
 
         static std::string print_cmdline( const cmdline &args )
@@ -36,10 +86,32 @@ namespace regex
             positionals_.push_back( std::make_tuple( var, t, description ) );
         }
 
+        void cmdline::add_variadic( const std::string &var, const std::string &description )
+        {
+            args_[var] = std::vector<std::string>();
+            variadic_ = std::make_tuple( var, description );
+        }
+
+        void cmdline::waive( const std::string &positional, const std::string &optional )
+        {
+            waivers_[positional] = optional;
+        }
+
         void cmdline::add_optional( const std::string &arg, const std::string &var, type t, const std::any &def,
                                     const std::string &description, const std::vector<std::any> &options )
         {
-            args_[var] = def;
+            /*
+             * A string literal default is fetched as a std::string like any value parsed for it
+             */
+            if ( def.type() == typeid( const char * ) )
+            {
+                args_[var] = std::string( std::any_cast<const char *>( def ) );
+            }
+            else
+            {
+                args_[var] = def;
+            }
+
             optionals_.insert( { arg, std::make_tuple( var, t, description, options ) } );
         }
 
@@ -59,7 +131,10 @@ namespace regex
             {
                 const auto arg = std::string( argv[i] );
 
-                if ( arg.starts_with( "-" ) )
+                /*
+                 * A lone - is a positional, conventionally naming standard input
+                 */
+                if ( arg.starts_with( "-" ) && arg != "-" )
                 {
                     const auto flag_iter = flags_.find( arg );
 
@@ -91,7 +166,20 @@ namespace regex
                                 }
                                 else
                                 {
-                                    args_[std::get<0>( opt_iter->second )] = parse_string( val );
+                                    const auto &options = std::get<3>( opt_iter->second );
+
+                                    if ( !options.empty() &&
+                                         std::none_of( std::cbegin( options ), std::cend( options ),
+                                                       [&val]( const std::any &option ) {
+                                                           return val == std::any_cast<const char *>( option );
+                                                       } ) )
+                                    {
+                                        throw exception( "Invalid value " + val );
+                                    }
+
+                                    args_[std::get<0>( opt_iter->second )] =
+                                        parse_value( val, std::get<1>( opt_iter->second ) );
+                                    supplied_.insert( arg );
                                 }
                             }
                         }
@@ -110,6 +198,10 @@ namespace regex
                         args_[std::get<0>( *positional )] = arg;
                         ++positional;
                     }
+                    else if ( variadic_ )
+                    {
+                        std::any_cast<std::vector<std::string> &>( args_[std::get<0>( *variadic_ )] ).push_back( arg );
+                    }
                     else
                     {
                         throw exception( "Too many positionals provided\n" + print_cmdline( *this ) );
@@ -117,9 +209,16 @@ namespace regex
                 }
             }
 
-            if ( positional != std::cend( positionals_ ) )
+            for ( ; positional != std::cend( positionals_ ); ++positional )
             {
-                throw exception( "Not all positional arguments supplied\n" + print_cmdline( *this ) );
+                const auto waiver = waivers_.find( std::get<0>( *positional ) );
+
+                if ( waiver == std::cend( waivers_ ) || !supplied_.contains( waiver->second ) )
+                {
+                    throw exception( "Not all positional arguments supplied\n" + print_cmdline( *this ) );
+                }
+
+                args_[std::get<0>( *positional )] = empty_value( std::get<1>( *positional ) );
             }
         }
 
@@ -144,26 +243,61 @@ namespace regex
 
         std::ostream &operator<<( std::ostream &os, const cmdline &c )
         {
+            /*
+             * Columns of arguments and names, a space wider than the widest of either
+             */
+            std::size_t args = 9, names = 14;
+            for ( const auto &positional : c.positionals_ )
+            {
+                names = std::max( names, std::get<0>( positional ).size() );
+            }
+            if ( c.variadic_ )
+            {
+                names = std::max( names, std::get<0>( *c.variadic_ ).size() );
+            }
+            for ( const auto &optional : c.optionals_ )
+            {
+                args = std::max( args, optional.first.size() );
+                names = std::max( names, std::get<0>( optional.second ).size() );
+            }
+            for ( const auto &flag : c.flags_ )
+            {
+                args = std::max( args, flag.first.size() );
+                names = std::max( names, std::get<0>( flag.second ).size() );
+            }
+            const auto args_width = static_cast<int>( args + 1 ), names_width = static_cast<int>( names + 1 );
+
             os << std::left;
-            os << "Usage: " << c.name_ << " [OPTIONS|FLAGS] " << c.positionals_ << '\n';
+            os << "Usage: " << c.name_ << " [OPTIONS|FLAGS] " << c.positionals_;
+            if ( c.variadic_ )
+            {
+                os << std::get<0>( *c.variadic_ ) << "... ";
+            }
+            os << '\n';
             os << c.description_ << '\n';
             os << '\n';
             os << "Positionals\n";
             for ( const auto &positional : c.positionals_ )
             {
-                os << std::setw( 10 ) << ' ' << std::setw( 15 ) << std::get<0>( positional )
+                os << std::setw( args_width ) << ' ' << std::setw( names_width ) << std::get<0>( positional )
                    << std::get<2>( positional ) << '\n';
             }
+            if ( c.variadic_ )
+            {
+                os << std::setw( args_width ) << ' ' << std::setw( names_width ) << std::get<0>( *c.variadic_ )
+                   << std::get<1>( *c.variadic_ ) << '\n';
+            }
             os << "Optionals\n";
             for ( const auto &optional : c.optionals_ )
             {
-                os << std::setw( 10 ) << optional.first << std::setw( 15 ) << std::get<0>( optional.second )
-                   << std::get<2>( optional.second ) << " { " << std::get<3>( optional.second ) << '}' << '\n';
+                os << std::setw( args_width ) << optional.first << std::setw( names_width )
+                   << std::get<0>( optional.second ) << std::get<2>( optional.second ) << " { "
+                   << std::get<3>( optional.second ) << '}' << '\n';
             }
             os << "Flags\n";
             for ( const auto &flag : c.flags_ )
             {
-                os << std::setw( 10 ) << flag.first << std::setw( 15 ) << std::get<0>( flag.second )
+                os << std::setw( args_width ) << flag.first << std::setw( names_width ) << std::get<0>( flag.second )
                    << std::get<1>( flag.second ) << '\n';
             }
             return os;
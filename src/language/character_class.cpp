@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "regex/language/character_class.h"
+
+namespace regex::language
+{
+    character_class::character_class( code_point lower, code_point upper )
+    {
+        insert( lower, upper );
+    }
+
+    void character_class::insert( code_point lower, code_point upper )
+    {
+        auto first = std::lower_bound( std::begin( ranges_ ), std::end( ranges_ ), lower,
+                                       []( const range &r, code_point c ) { return r.upper + 1 < c; } );
+        auto last = first;
+
+        while( last != std::end( ranges_ ) && last->lower <= upper + 1 )
+        {
+            lower = std::min( lower, last->lower );
+            upper = std::max( upper, last->upper );
+            ++last;
+        }
+
+        ranges_.insert( ranges_.erase( first, last ), range{ lower, upper } );
+    }
+
+    void character_class::insert( const character_class &other )
+    {
+        for( const auto &r : other.ranges_ )
+        {
+            insert( r.lower, r.upper );
+        }
+    }
+
+    character_class character_class::complement( code_point max ) const
+    {
+        character_class result;
+        code_point next = 0;
+
+        for( const auto &r : ranges_ )
+        {
+            if( r.lower > max )
+            {
+                break;
+            }
+
+            if( r.lower > next )
+            {
+                result.ranges_.push_back( { next, r.lower - 1 } );
+            }
+
+            next = r.upper + 1;
+        }
+
+        if( next <= max )
+        {
+            result.ranges_.push_back( { next, max } );
+        }
+
+        return result;
+    }
+
+    /*
+     * Blocks of upper case letters whose lower case letters are at a constant offset
+     */
+    struct case_block
+    {
+        character_class::code_point lower;
+        character_class::code_point upper;
+        character_class::code_point offset;
+    };
+
+    static constexpr case_block case_blocks[]{
+        { 'A', 'Z', 0x20 },     { 0xC0, 0xD6, 0x20 },   { 0xD8, 0xDE, 0x20 },  { 0x391, 0x3A1, 0x20 },
+        { 0x3A3, 0x3AB, 0x20 }, { 0x400, 0x40F, 0x50 }, { 0x410, 0x42F, 0x20 },
+    };
+
+    character_class character_class::fold( code_point max ) const
+    {
+        character_class result = *this;
+
+        for( const auto &block : case_blocks )
+        {
+            if( block.upper > 0x7F && max <= byte_max )
+            {
+                break;
+            }
+
+            for( const auto &r : ranges_ )
+            {
+                const auto lower = std::max( r.lower, block.lower );
+                const auto upper = std::min( r.upper, block.upper );
+
+                if( lower <= upper )
+                {
+                    result.insert( lower + block.offset, upper + block.offset );
+                }
+
+                const auto folded_lower = std::max( r.lower, block.lower + block.offset );
+                const auto folded_upper = std::min( r.upper, block.upper + block.offset );
+
+                if( folded_lower <= folded_upper )
+                {
+                    result.insert( folded_lower - block.offset, folded_upper - block.offset );
+                }
+            }
+        }
+
+        return result;
+    }
+
+    bool character_class::contains( code_point c ) const
+    {
+        const auto r = std::lower_bound( std::cbegin( ranges_ ), std::cend( ranges_ ), c,
+                                         []( const range &r, code_point c ) { return r.upper < c; } );
+
+        return r != std::cend( ranges_ ) && r->lower <= c;
+    }
+
+    const std::vector<character_class::range> &character_class::ranges() const
+    {
+        return ranges_;
+    }
+
+    character_class character_class::digit()
+    {
+        return character_class( '0', '9' );
+    }
+
+    character_class character_class::word()
+    {
+        character_class result( '0', '9' );
+        result.insert( 'A', 'Z' );
+        result.insert( '_', '_' );
+        result.insert( 'a', 'z' );
+        return result;
+    }
+
+    character_class character_class::space()
+    {
+        character_class result( '\t', '\r' );
+        result.insert( ' ', ' ' );
+        return result;
+    }
+
+    static void append_escaped( std::basic_string<character_type> &output, character_class::code_point c,
+                                std::basic_string_view<character_type> special )
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+
+        if( c > character_class::byte_max )
+        {
+            std::basic_string<character_type> digits;
+
+            for( ; c != 0; c >>= 4 )
+                digits.insert( std::begin( digits ), hex[c & 0xF] );
+
+            output += "\\x{" + digits + "}";
+        }
+        else if( c < 0x20 || c >= 0x7F )
+        {
+            output += "\\x";
+            output.push_back( hex[( c >> 4 ) & 0xF] );
+            output.push_back( hex[c & 0xF] );
+        }
+        else
+        {
+            if( special.find( static_cast<character_type>( c ) ) != std::basic_string_view<character_type>::npos )
+            {
+                output.push_back( '\\' );
+            }
+
+            output.push_back( static_cast<character_type>( c ) );
+        }
+    }
+
+    std::basic_string<character_type> to_string( const character_class &c )
+    {
+        std::basic_string<character_type> output;
+        const auto &ranges = c.ranges();
+
+        if( ranges.size() == 1 && ranges.front().lower == ranges.front().upper )
+        {
+            append_escaped( output, ranges.front().lower, "()*+?|.[]\\{}-" );
+            return output;
+        }
+
+        const bool negated = ranges.size() > 1 && ranges.front().lower == 0 &&
+                             ( ranges.back().upper == character_class::byte_max ||
+                               ranges.back().upper == character_class::code_point_max );
+        const auto members = negated ? c.complement( ranges.back().upper ) : c;
+
+        output += negated ? "[^" : "[";
+
+        for( const auto &r : members.ranges() )
+        {
+            append_escaped( output, r.lower, "[]\\^-" );
+
+            if( r.upper > r.lower + 1 )
+            {
+                output.push_back( '-' );
+            }
+
+            if( r.upper > r.lower )
+            {
+                append_escaped( output, r.upper, "[]\\^-" );
+            }
+        }
+
+        output.push_back( ']' );
+
+        return output;
+    }
+} // namespace regex::language
@@ -1,7 +1,9 @@
 #include <sstream>
-#include <stack>
+#include <stdexcept>
+#include <string>
 
 #include "regex/language/parser.h"
+#include "regex/language/utf8.h"
 
 namespace regex::language
 {
@@ -10,64 +12,278 @@ namespace regex::language
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 3, 3, 2, 2, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0,
 
     };
 
-    constexpr bool is_operator( language::character_type token )
+    static std::size_t escape_length( std::basic_string_view<character_type> expression, std::size_t position )
     {
-        switch( token )
+        if( position + 1 >= expression.size() )
+            throw std::runtime_error( "Expected a character to follow \\ at " + std::to_string( position ) );
+
+        if( expression[position + 1] != 'x' )
+            return 2;
+
+        if( position + 2 < expression.size() && expression[position + 2] == '{' )
         {
-        case '*':
-        case '?':
-        case '+':
-        case '-':
-        case '|':
-        case '(':
-        case ')':
-            return true;
-        default:
-            return false;
+            const std::size_t end = expression.find( '}', position );
+
+            if( end == std::basic_string_view<character_type>::npos )
+                throw std::runtime_error( "Unterminated hexadecimal escape at " + std::to_string( position ) );
+
+            return end + 1 - position;
+        }
+
+        return 4;
+    }
+
+    std::size_t atom_length( std::basic_string_view<character_type> expression, std::size_t position )
+    {
+        if( expression[position] == '\\' )
+        {
+            return escape_length( expression, position );
+        }
+        else if( expression[position] == '[' )
+        {
+            std::size_t end = position + 1;
+
+            if( end < expression.size() && expression[end] == '^' )
+                ++end;
+
+            if( end < expression.size() && expression[end] == ']' )
+                ++end;
+
+            while( end < expression.size() && expression[end] != ']' )
+            {
+                end += expression[end] == '\\' ? escape_length( expression, end ) : 1;
+            }
+
+            if( end >= expression.size() )
+                throw std::runtime_error( "Unterminated bracket expression at " + std::to_string( position ) );
+
+            return end + 1 - position;
+        }
+        else if( expression[position] == '{' )
+        {
+            const std::size_t end = expression.find( '}', position );
+
+            if( end == std::basic_string_view<character_type>::npos )
+                throw std::runtime_error( "Unterminated repetition at " + std::to_string( position ) );
+
+            return end + 1 - position;
+        }
+        else
+        {
+            return 1;
+        }
+    }
+
+    static std::uint32_t parse_count( std::basic_string_view<character_type> digits,
+                                      std::basic_string_view<character_type> atom )
+    {
+        std::uint32_t count = 0;
+
+        if( digits.empty() )
+            throw std::runtime_error( "Expected a repetition count in " + std::string( atom ) );
+
+        for( const character_type digit : digits )
+        {
+            if( digit < '0' || digit > '9' )
+                throw std::runtime_error( "Expected a repetition count in " + std::string( atom ) );
+
+            count = count * 10 + ( digit - '0' );
+
+            if( count > repetition_limit )
+                throw std::runtime_error( "Repetition count exceeds " + std::to_string( repetition_limit ) + " in " +
+                                          std::string( atom ) );
+        }
+
+        return count;
+    }
+
+    std::pair<std::uint32_t, std::uint32_t> make_bounds( std::basic_string_view<character_type> atom )
+    {
+        if( atom.size() < 3 || atom.front() != '{' || atom.back() != '}' )
+            throw std::runtime_error( "Expected a repetition, got " + std::string( atom ) );
+
+        const auto counts = atom.substr( 1, atom.size() - 2 );
+        const auto comma = counts.find( ',' );
+
+        if( comma == std::basic_string_view<character_type>::npos )
+        {
+            const auto count = parse_count( counts, atom );
+            return { count, count };
         }
+
+        const auto min = parse_count( counts.substr( 0, comma ), atom );
+
+        if( comma + 1 == counts.size() )
+            return { min, repetition_unbounded };
+
+        const auto max = parse_count( counts.substr( comma + 1 ), atom );
+
+        if( max < min )
+            throw std::runtime_error( "Repetition maximum is less than its minimum in " + std::string( atom ) );
+
+        return { min, max };
     }
 
-    constexpr bool is_unary_operator( language::character_type token )
+    bool is_class( std::basic_string_view<character_type> atom )
+    {
+        return !atom.empty() && ( atom[0] == '\\' || atom[0] == '[' );
+    }
+
+    static character_class::code_point parse_hex( std::basic_string_view<character_type> digits,
+                                                  syntax_flag flags )
+    {
+        character_class::code_point value = 0;
+
+        if( digits.size() > 2 && digits.front() == '{' && digits.back() == '}' )
+            digits = digits.substr( 1, digits.size() - 2 );
+
+        for( const character_type digit : digits )
+        {
+            if( value > max_code_point( flags ) )
+                break;
+
+            value <<= 4;
+
+            if( digit >= '0' && digit <= '9' )
+                value |= digit - '0';
+            else if( digit >= 'a' && digit <= 'f' )
+                value |= digit - 'a' + 10;
+            else if( digit >= 'A' && digit <= 'F' )
+                value |= digit - 'A' + 10;
+            else
+                throw std::runtime_error( "Invalid hexadecimal escape \\x" + std::string( digits ) );
+        }
+
+        if( value > max_code_point( flags ) )
+            throw std::runtime_error( "Hexadecimal escape \\x" + std::string( digits ) + " exceeds the largest " +
+                                      ( is_set( flags, syntax_flag::utf8 ) ? "code point" : "byte" ) );
+
+        return value;
+    }
+    /*
+     * Parse the escape sequence at position, leaving position after it
+     */
+    static character_class parse_escape( std::basic_string_view<character_type> atom, std::size_t &position,
+                                         syntax_flag flags )
     {
-        switch( token )
+        const auto max = max_code_point( flags );
+        const std::size_t length = escape_length( atom, position );
+        const character_type escaped = atom[position + 1];
+
+        if( position + length > atom.size() )
+            throw std::runtime_error( "Incomplete escape sequence " + std::string( atom.substr( position ) ) );
+
+        const auto hex = atom.substr( position + 2, length - 2 );
+        position += length;
+
+        switch( escaped )
         {
-        case '*':
-        case '?':
-        case '+':
-        case '-':
-        case ')':
-            return true;
+        case 'd':
+            return character_class::digit();
+        case 'D':
+            return character_class::digit().complement( max );
+        case 'w':
+            return character_class::word();
+        case 'W':
+            return character_class::word().complement( max );
+        case 's':
+            return character_class::space();
+        case 'S':
+            return character_class::space().complement( max );
+        case 'x': {
+            const auto c = parse_hex( hex, flags );
+            return character_class( c, c );
+        }
+        case 'n':
+            return character_class( '\n', '\n' );
+        case 'r':
+            return character_class( '\r', '\r' );
+        case 't':
+            return character_class( '\t', '\t' );
+        case 'f':
+            return character_class( '\f', '\f' );
+        case 'v':
+            return character_class( '\v', '\v' );
         default:
-            return false;
+            return character_class( static_cast<unsigned char>( escaped ), static_cast<unsigned char>( escaped ) );
+        }
+    }
+    /*
+     * Parse a single character or escape sequence within a bracket expression
+     */
+    static character_class parse_bracket_item( std::basic_string_view<character_type> atom, std::size_t &position,
+                                               syntax_flag flags )
+    {
+        if( atom[position] == '\\' )
+        {
+            return parse_escape( atom, position, flags );
+        }
+        else if( is_set( flags, syntax_flag::utf8 ) )
+        {
+            const auto c = utf8::decode( atom, position );
+            return character_class( c, c );
+        }
+        else
+        {
+            const auto c = static_cast<unsigned char>( atom[position++] );
+            return character_class( c, c );
         }
     }
 
-    constexpr static bool is_character( language::character_type token )
+    static bool is_single( const character_class &c )
     {
-        return !is_operator( token ) && token != 0;
+        return c.ranges().size() == 1 && c.ranges().front().lower == c.ranges().front().upper;
     }
 
-    std::basic_string<character_type> make_explicit( std::basic_string_view<character_type> expression )
+    character_class make_class( std::basic_string_view<character_type> atom, syntax_flag flags )
     {
-        character_type pcharacter = 0;
-        std::basic_string<character_type> output;
+        std::size_t position = 0;
+
+        if( atom.empty() || atom.size() != atom_length( atom, 0 ) || !is_class( atom ) )
+            throw std::runtime_error( "Expected a single escape sequence or bracket expression, got " +
+                                      std::string( atom ) );
+
+        const auto max = max_code_point( flags );
+        const bool fold = is_set( flags, syntax_flag::case_insensitive );
 
-        for( char character : expression )
+        if( atom[0] == '\\' )
         {
-            if( ( is_character( character ) || character == '(' ) &&
-                ( is_unary_operator( pcharacter ) || is_character( pcharacter ) ) )
+            const auto escaped = parse_escape( atom, position, flags );
+            return fold ? escaped.fold( max ) : escaped;
+        }
+
+        character_class result;
+        const bool negated = atom[1] == '^';
+        position = negated ? 2 : 1;
+        const std::size_t end = atom.size() - 1;
+
+        do
+        {
+            const auto lower = parse_bracket_item( atom, position, flags );
+
+            if( is_single( lower ) && position + 1 < end && atom[position] == '-' )
             {
-                output.push_back( '-' );
+                ++position;
+                const auto upper = parse_bracket_item( atom, position, flags );
+
+                if( !is_single( upper ) || upper.ranges().front().lower < lower.ranges().front().lower )
+                    throw std::runtime_error( "Invalid range in bracket expression " + std::string( atom ) );
+
+                result.insert( lower.ranges().front().lower, upper.ranges().front().lower );
             }
+            else
+            {
+                result.insert( lower );
+            }
+        } while( position < end );
 
-            output.push_back( character );
-            pcharacter = character;
-        }
+        if( fold )
+            result = result.fold( max );
 
-        return output;
+        return negated ? result.complement( max ) : result;
     }
 } // namespace regex::language
\ No newline at end of file
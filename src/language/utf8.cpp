@@ -0,0 +1,187 @@
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "regex/language/utf8.h"
+
+namespace regex::language::utf8
+{
+    /*
+     * Largest code point encoded by 1, 2, 3 and 4 bytes
+     */
+    static constexpr std::array<character_class::code_point, 4> encoded_max{ 0x7F, 0x7FF, 0xFFFF, 0x10FFFF };
+
+    static constexpr character_class::code_point surrogate_lower = 0xD800;
+    static constexpr character_class::code_point surrogate_upper = 0xDFFF;
+
+    static std::size_t encoded_length( character_class::code_point c )
+    {
+        std::size_t length = 1;
+
+        while( c > encoded_max[length - 1] )
+            ++length;
+
+        return length;
+    }
+
+    character_class::code_point decode( std::basic_string_view<character_type> text, std::size_t &position )
+    {
+        const auto invalid = [&]() {
+            return std::runtime_error( "Invalid UTF-8 at " + std::to_string( position ) );
+        };
+
+        const auto lead = static_cast<unsigned char>( text[position] );
+        std::size_t length;
+        character_class::code_point c;
+
+        if( lead < 0x80 )
+        {
+            ++position;
+            return lead;
+        }
+        else if( lead >= 0xC2 && lead <= 0xDF )
+        {
+            length = 2;
+            c = lead & 0x1F;
+        }
+        else if( lead >= 0xE0 && lead <= 0xEF )
+        {
+            length = 3;
+            c = lead & 0x0F;
+        }
+        else if( lead >= 0xF0 && lead <= 0xF4 )
+        {
+            length = 4;
+            c = lead & 0x07;
+        }
+        else
+        {
+            throw invalid();
+        }
+
+        if( position + length > text.size() )
+            throw invalid();
+
+        for( std::size_t i = 1; i < length; ++i )
+        {
+            const auto continuation = static_cast<unsigned char>( text[position + i] );
+
+            if( ( continuation & 0xC0 ) != 0x80 )
+                throw invalid();
+
+            c = ( c << 6 ) | ( continuation & 0x3F );
+        }
+        /*
+         * Overlong encodings, surrogates and code points beyond the last plane are invalid
+         */
+        if( encoded_length( c ) != length || ( c >= surrogate_lower && c <= surrogate_upper ) ||
+            c > character_class::code_point_max )
+            throw invalid();
+
+        position += length;
+
+        return c;
+    }
+
+    static std::array<unsigned char, 4> encode( character_class::code_point c, std::size_t length )
+    {
+        static constexpr std::array<unsigned char, 4> lead{ 0x00, 0xC0, 0xE0, 0xF0 };
+        std::array<unsigned char, 4> bytes{};
+
+        for( std::size_t i = length - 1; i > 0; --i )
+        {
+            bytes[i] = static_cast<unsigned char>( 0x80 | ( c & 0x3F ) );
+            c >>= 6;
+        }
+
+        bytes[0] = static_cast<unsigned char>( lead[length - 1] | c );
+
+        return bytes;
+    }
+
+    void encode( character_class::code_point c, std::basic_string<character_type> &output )
+    {
+        const auto length = encoded_length( c );
+        const auto bytes = encode( c, length );
+
+        for( std::size_t i = 0; i < length; ++i )
+            output.push_back( static_cast<character_type>( bytes[i] ) );
+    }
+    /*
+     * Split each range until its lower and upper bounds differ only in trailing bytes spanning every continuation,
+     * when the bytes of the range are the ranges between the bytes of its bounds
+     */
+    std::vector<sequence> sequences( const character_class &characters )
+    {
+        std::vector<sequence> result;
+        std::vector<character_class::range> pending;
+
+        for( auto r = std::crbegin( characters.ranges() ); r != std::crend( characters.ranges() ); ++r )
+        {
+            if( r->lower <= character_class::code_point_max )
+                pending.push_back( { r->lower, std::min( r->upper, character_class::code_point_max ) } );
+        }
+
+        while( !pending.empty() )
+        {
+            auto [lower, upper] = pending.back();
+            pending.pop_back();
+
+            if( lower <= surrogate_upper && upper >= surrogate_lower )
+            {
+                if( upper > surrogate_upper )
+                    pending.push_back( { surrogate_upper + 1, upper } );
+                if( lower < surrogate_lower )
+                    pending.push_back( { lower, surrogate_lower - 1 } );
+                continue;
+            }
+
+            const auto length = encoded_length( lower );
+
+            if( encoded_length( upper ) != length )
+            {
+                pending.push_back( { encoded_max[length - 1] + 1, upper } );
+                pending.push_back( { lower, encoded_max[length - 1] } );
+                continue;
+            }
+
+            bool split = false;
+
+            for( std::size_t trailing = 1; trailing < length && !split; ++trailing )
+            {
+                const character_class::code_point mask = ( 1u << ( 6 * trailing ) ) - 1;
+
+                if( ( lower & ~mask ) != ( upper & ~mask ) )
+                {
+                    if( ( lower & mask ) != 0 )
+                    {
+                        pending.push_back( { ( lower | mask ) + 1, upper } );
+                        pending.push_back( { lower, lower | mask } );
+                        split = true;
+                    }
+                    else if( ( upper & mask ) != mask )
+                    {
+                        pending.push_back( { upper & ~mask, upper } );
+                        pending.push_back( { lower, ( upper & ~mask ) - 1 } );
+                        split = true;
+                    }
+                }
+            }
+
+            if( split )
+                continue;
+
+            const auto lower_bytes = encode( lower, length );
+            const auto upper_bytes = encode( upper, length );
+            sequence s{ {}, length };
+
+            for( std::size_t i = 0; i < length; ++i )
+                s.bytes[i] = { lower_bytes[i], upper_bytes[i] };
+
+            result.push_back( s );
+        }
+
+        return result;
+    }
+} // namespace regex::language::utf8
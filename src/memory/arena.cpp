@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+#include "regex/memory/arena.h"
+
+namespace regex::memory
+{
+    arena::arena( std::size_t initial_size, std::pmr::memory_resource *upstream )
+        : upstream_( upstream ), next_size_( std::max<std::size_t>( initial_size, sizeof( chunk ) * 2 ) )
+    {
+    }
+
+    arena::~arena()
+    {
+        release();
+    }
+
+    void arena::release()
+    {
+        while ( chunks_ )
+        {
+            chunk *const previous = chunks_->previous;
+            upstream_->deallocate( chunks_, chunks_->size, alignof( std::max_align_t ) );
+            chunks_ = previous;
+        }
+
+        current_ = end_ = nullptr;
+        allocated_ = reserved_ = 0;
+    }
+
+    std::size_t arena::allocated() const
+    {
+        return allocated_;
+    }
+
+    std::size_t arena::reserved() const
+    {
+        return reserved_;
+    }
+
+    void arena::grow( std::size_t bytes, std::size_t alignment )
+    {
+        /*
+         * Enough for the header, the worst case padding and the request, doubling for the chunk after
+         */
+        const std::size_t size = std::max( next_size_, sizeof( chunk ) + alignment + bytes );
+        auto *const block = static_cast<chunk *>( upstream_->allocate( size, alignof( std::max_align_t ) ) );
+
+        block->previous = chunks_;
+        block->size = size;
+        chunks_ = block;
+
+        current_ = reinterpret_cast<std::byte *>( block + 1 );
+        end_ = reinterpret_cast<std::byte *>( block ) + size;
+        next_size_ = size * 2;
+        reserved_ += size;
+    }
+
+    void *arena::do_allocate( std::size_t bytes, std::size_t alignment )
+    {
+        void *p = current_;
+        std::size_t space = static_cast<std::size_t>( end_ - current_ );
+
+        if ( !current_ || !std::align( alignment, bytes, p, space ) )
+        {
+            grow( bytes, alignment );
+
+            p = current_;
+            space = static_cast<std::size_t>( end_ - current_ );
+            std::align( alignment, bytes, p, space );
+        }
+
+        current_ = static_cast<std::byte *>( p ) + bytes;
+        allocated_ += bytes;
+
+        return p;
+    }
+
+    void arena::do_deallocate( void *, std::size_t, std::size_t )
+    {
+    }
+
+    bool arena::do_is_equal( const std::pmr::memory_resource &other ) const noexcept
+    {
+        return this == &other;
+    }
+} // namespace regex::memory
@@ -1,23 +1,106 @@
-#include <fstream>
-#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
-#include <sstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
 
 #include "regex.h"
 #include "regex/automata/nfa.h"
+#include "regex/automata/pattern_set.h"
 #include "regex/language/parser.h"
 #include "regex/utilities/cmdline.h"
 #include "regex/utilities/compile.h"
+#include "regex/utilities/input.h"
+#include "regex/utilities/search.h"
+
+/*
+ * Every line of the file, or of standard input for "-"
+ */
+static std::vector<std::string> read_patterns( const std::filesystem::path &path )
+{
+    regex::input file( path );
+    std::vector<std::string> patterns;
+
+    for ( auto block = file.next(); !block.empty(); block = file.next() )
+    {
+        while ( !block.empty() )
+        {
+            const auto end = block.find( '\n' );
+
+            patterns.emplace_back( block.substr( 0, end ) );
+            block.remove_prefix( end == std::string_view::npos ? block.size() : end + 1 );
+        }
+    }
+
+    return patterns;
+}
+
+/*
+ * What was compiled and what the search cost, e.g.
+ *
+ *      compile   0.052 ms, dfa of 8 states in 2.1 KiB
+ *      search    10485760 bytes in 100000 lines, 1429 matches
+ *      time      0.041 s wall, 0.040 s cpu, 255.7 MB/s
+ */
+static void write_stats( std::ostream &output, const std::string &engine, const regex::compile_stats &compiled,
+                         const regex::searcher &searcher, std::chrono::duration<double> wall, double cpu )
+{
+    const auto flags = output.flags();
+    const auto compile_time = compiled.parse_time + compiled.simplify_time + compiled.nfa_time + compiled.dfa_time;
+    const bool deterministic = compiled.dfa_states > 0;
+
+    output << std::fixed << std::setprecision( 3 ) << std::left;
+    output << std::setw( 10 ) << "compile" << std::chrono::duration<double, std::milli>( compile_time ).count()
+           << " ms, " << engine;
+
+    if ( compiled.nfa_states > 0 )
+    {
+        output << " of " << ( deterministic ? compiled.dfa_states : compiled.nfa_states ) << " states in "
+               << std::setprecision( 1 ) << ( deterministic ? compiled.dfa_bytes : compiled.nfa_bytes ) / 1024.0
+               << " KiB";
+    }
+
+    output << '\n'
+           << std::setw( 10 ) << "search" << searcher.bytes() << " bytes in " << searcher.lines() << " lines, "
+           << searcher.matches() << " matches\n";
+    output << std::setw( 10 ) << "time" << std::setprecision( 3 ) << wall.count() << " s wall, " << cpu
+           << " s cpu, " << std::setprecision( 1 )
+           << ( wall.count() > 0 ? static_cast<double>( searcher.bytes() ) / wall.count() / 1e6 : 0.0 )
+           << " MB/s\n";
+
+    output.flags( flags );
+}
 
 int main( int argc, const char **argv )
 {
+    std::ios_base::sync_with_stdio( false );
+
     regex::cmd::cmdline args( "Pattern matching tool" );
     args.add_flag( "--version", "version", "Version number" );
-    args.add_flag( "-v", "verbose", "Verbose logging" );
-    args.add_positional( "expression", regex::cmd::cmdline::type::string, "Regular expression" );
-    args.add_positional( "target", regex::cmd::cmdline::type::string, "Target to match" );
-    args.add_optional( "-t", "type", regex::cmd::cmdline::type::string, "nfa", "Type of finite automata",
-                       { "nfa", "dfa" } );
+    args.add_flag( "--stats", "stats", "Write what was compiled and what the search cost to standard error" );
+    args.add_flag( "-u", "utf8", "Match UTF-8 characters rather than bytes" );
+    args.add_flag( "-i", "ignore-case", "Match letters in either case" );
+    args.add_positional( "expression", regex::cmd::cmdline::type::string,
+                         "Regular expression, or the first target if -f is given" );
+    args.add_variadic( "targets", "Files or directories to match, or - for standard input as when none are given" );
+    args.add_optional( "-f", "patterns", regex::cmd::cmdline::type::string, "",
+                       "File of regular expressions, one per line, writing which match each line" );
+    args.waive( "expression", "-f" );
+    args.add_optional( "-t", "type", regex::cmd::cmdline::type::string, "auto",
+                       "Type of finite automata, auto choosing by the expression", { "auto", "nfa", "dfa", "lazy" } );
+    args.add_optional( "-j", "jobs", regex::cmd::cmdline::type::integral, 1, "Threads matching in parallel" );
+    args.add_optional( "-m", "max-count", regex::cmd::cmdline::type::integral, 0,
+                       "Stop reading a file after this many matching lines" );
+    args.add_flag( "-c", "count", "Write the number of matching lines of each file" );
+    args.add_flag( "-l", "files-with-matches", "Write the path of each file with a matching line" );
+    args.add_flag( "-q", "quiet", "Write nothing, exiting with 0 at the first matching line" );
 
     try
     {
@@ -25,9 +108,9 @@ int main( int argc, const char **argv )
     }
     catch ( const regex::cmd::exception &e )
     {
-        std::cout << "Regex version " << REGEX_VERSION_MAJOR << "." << REGEX_VERSION_MINOR << std::endl;
+        std::cerr << "Regex version " << REGEX_VERSION_MAJOR << "." << REGEX_VERSION_MINOR << '\n';
         std::cerr << e.what() << '\n';
-        return 1;
+        return 2;
     }
 
     if ( args.get_flag( "version" ) )
@@ -36,23 +119,120 @@ int main( int argc, const char **argv )
         return 0;
     }
 
+    const auto patterns_path = args.get_argument<std::string>( "patterns" );
     std::string pattern( args.get_argument<std::string>( "expression" ) );
-    std::string target( args.get_argument<std::string>( "target" ) );
-    regex::compile_flag flag =
-        args.get_argument<std::string>( "type" ) == "nfa" ? regex::compile_flag::nfa : regex::compile_flag::dfa;
+    auto names = args.get_argument<std::vector<std::string>>( "targets" );
+
+    if ( !patterns_path.empty() && !pattern.empty() )
+    {
+        names.insert( std::cbegin( names ), std::move( pattern ) );
+    }
+
+    if ( names.empty() )
+    {
+        names.emplace_back( "-" );
+    }
+
+    const std::vector<std::filesystem::path> targets( std::cbegin( names ), std::cend( names ) );
+    const auto type = args.get_argument<std::string>( "type" );
+    const auto flag = type == "nfa"    ? regex::compile_flag::nfa
+                      : type == "dfa"  ? regex::compile_flag::dfa
+                      : type == "lazy" ? regex::compile_flag::lazy
+                                       : regex::compile_flag::automatic;
+
+    auto syntax = regex::language::syntax_flag::none;
+
+    if ( args.get_flag( "utf8" ) )
+    {
+        syntax = syntax | regex::language::syntax_flag::utf8;
+    }
 
-    std::shared_ptr<regex::fa> automata = regex::compile( std::move( pattern ), flag );
+    if ( args.get_flag( "ignore-case" ) )
+    {
+        syntax = syntax | regex::language::syntax_flag::case_insensitive;
+    }
 
-    std::ifstream file( target, std::ios_base::in );
-    std::string line;
+    const auto wall_start = std::chrono::steady_clock::now();
+    const auto cpu_start = std::clock();
 
-    while ( std::getline( file, line ) )
+    std::shared_ptr<regex::fa> automata;
+    std::shared_ptr<regex::pattern_set> patterns;
+    regex::compile_stats compiled;
+
+    try
     {
-        if ( automata->execute( line ) )
+        if ( !patterns_path.empty() )
         {
-            std::cout << line << std::endl;
+            auto expressions = read_patterns( patterns_path );
+            const auto start = std::chrono::steady_clock::now();
+
+            patterns = regex::compile_patterns( expressions, syntax );
+            compiled.nfa_time = std::chrono::steady_clock::now() - start;
+        }
+        else
+        {
+            automata = regex::compile( pattern, flag, syntax, compiled );
         }
     }
+    catch ( const std::runtime_error &e )
+    {
+        std::cerr << e.what() << '\n';
+        return 2;
+    }
+
+    regex::search_options options;
+
+    if ( args.get_flag( "quiet" ) )
+    {
+        options.mode = regex::search_mode::quiet;
+    }
+    else if ( args.get_flag( "files-with-matches" ) )
+    {
+        options.mode = regex::search_mode::files;
+    }
+    else if ( args.get_flag( "count" ) )
+    {
+        options.mode = regex::search_mode::count;
+    }
+
+    options.max_count = static_cast<std::uint64_t>( std::max( args.get_argument<int>( "max-count" ), 0 ) );
+    options.threads = static_cast<std::size_t>( std::max( args.get_argument<int>( "jobs" ), 1 ) );
+    options.with_filename = targets.size() > 1 || std::any_of( std::cbegin( targets ), std::cend( targets ),
+                                                               []( const std::filesystem::path &target ) {
+                                                                   std::error_code error;
+                                                                   return std::filesystem::is_directory( target,
+                                                                                                         error );
+                                                               } );
+
+    /*
+     * Matching lines are written in buffers of whole chunks, so a large stream buffer saves a write per chunk
+     */
+    static char buffer[1 << 16];
+    std::cout.rdbuf()->pubsetbuf( buffer, sizeof( buffer ) );
+
+    const auto searcher = patterns ? std::make_unique<regex::searcher>( *patterns, std::cout, options )
+                                   : std::make_unique<regex::searcher>( *automata, std::cout, options );
+    const bool read = searcher->search( targets, std::cerr );
+
+    std::cout.flush();
+
+    if ( args.get_flag( "stats" ) )
+    {
+        const auto engine = patterns ? "lazy dfa of " + std::to_string( patterns->size() ) + " patterns"
+                            : compiled.engine == regex::compile_flag::dfa  ? std::string( "dfa" )
+                            : compiled.engine == regex::compile_flag::lazy ? std::string( "lazy dfa over an nfa" )
+                                                                           : std::string( "nfa" );
+
+        write_stats( std::cerr, engine, compiled, *searcher, std::chrono::steady_clock::now() - wall_start,
+                     static_cast<double>( std::clock() - cpu_start ) / CLOCKS_PER_SEC );
+    }
+    /*
+     * As grep, 0 if any line matched, 1 if none did and 2 on an error unless quietly matched
+     */
+    if ( options.mode == regex::search_mode::quiet && searcher->matches() > 0 )
+    {
+        return 0;
+    }
 
-    return 0;
+    return !read ? 2 : searcher->matches() > 0 ? 0 : 1;
 }
\ No newline at end of file
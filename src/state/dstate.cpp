@@ -7,14 +7,24 @@
 #include <vector>
 
 #include "regex/state/dstate.h"
+#include "regex/utilities/metrics.h"
 
 namespace regex::state
 {
 
-    void dstate::connect( dstate *target, transition_label_type transition_label )
+    void dstate::connect( dstate *target, transition_label_type lower, transition_label_type upper )
     {
-        assert( !transitions_.contains( transition_label ) );
-        transitions_[transition_label] = target;
+        assert( lower <= upper );
+        assert( transitions_.empty() || transitions_.back().upper < lower );
+
+        if ( !transitions_.empty() && transitions_.back().target == target && transitions_.back().upper + 1 == lower )
+        {
+            transitions_.back().upper = upper;
+        }
+        else
+        {
+            transitions_.push_back( { lower, upper, target } );
+        }
     }
 
     const dstate::transitions_type &dstate::transitions() const
@@ -22,42 +32,45 @@ namespace regex::state
         return transitions_;
     }
 
-    bool execute_internal(
-        const dstate *state, const dstate::group_type &outputs,
-        std::basic_string_view<dstate::transition_label_type> target,
-        std::vector<std::pair<const dstate *, std::basic_string_view<dstate::transition_label_type>>> &visited )
+    const dstate *dstate::next( transition_label_type character ) const
     {
-        if ( std::find_if( std::cbegin( visited ), std::cend( visited ), [state, target]( const auto &visit ) {
-                 return ( visit.first == state && visit.second == target );
-             } ) != std::cend( visited ) )
-        {
-            return false;
-        }
-
-        visited.emplace_back( state, target );
+        const auto next_transition =
+            std::lower_bound( std::cbegin( transitions_ ), std::cend( transitions_ ), character,
+                              []( const transition &t, transition_label_type c ) { return t.upper < c; } );
 
-        if ( target.empty() )
+        if ( next_transition != std::cend( transitions_ ) && next_transition->lower <= character )
         {
-            return outputs.contains( state );
-        }
-
-        const auto next_transitions = state->transitions().find( target[0] );
-
-        if ( next_transitions != std::cend( state->transitions() ) )
-        {
-            return execute_internal( next_transitions->second, outputs, target.substr( 1 ), visited );
+            return next_transition->target;
         }
         else
         {
-            return false;
+            return nullptr;
         }
-    };
+    }
 
     bool execute( const dstate *input, const dstate::group_type &ouputs,
-                  std::basic_string_view<dstate::transition_label_type> target )
+                  std::basic_string_view<language::character_type> target )
     {
-        std::vector<std::pair<const dstate *, std::basic_string_view<dstate::transition_label_type>>> visited;
+        const dstate *state = input;
+        std::uint64_t read = 0;
+
+        for ( const auto character : target )
+        {
+            state = state->next( static_cast<dstate::transition_label_type>( character ) );
+            ++read;
+
+            if ( !state )
+            {
+                break;
+            }
+        }
+        /*
+         * A deterministic automaton takes exactly one transition per character read, but for the last one read if
+         * it has none
+         */
+        metrics::add( metrics::counter::bytes, read );
+        metrics::add( metrics::counter::transitions, state ? read : read - 1 );
 
-        return execute_internal( input, ouputs, target, visited );
+        return state && ouputs.contains( state );
     }
-} // namespace regex::state
\ No newline at end of file
+} // namespace regex::state
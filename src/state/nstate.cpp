@@ -1,87 +1,424 @@
 #include <algorithm>
-#include <map>
-#include <memory>
-#include <set>
+#include <limits>
+#include <optional>
+#include <span>
 #include <string_view>
 #include <vector>
 
 #include "regex/state/nstate.h"
+#include "regex/utilities/metrics.h"
 
 namespace regex::state
 {
+    ngraph::ngraph( std::pmr::memory_resource *resource )
+        : states_( resource ), transitions_( resource ), epsilons_( resource )
+    {
+    }
+
+    ngraph::ngraph( const ngraph &other, std::pmr::memory_resource *resource )
+        : states_( other.states_, resource )
+        , transitions_( other.transitions_, resource )
+        , epsilons_( other.epsilons_, resource )
+        , compact_( other.compact_ )
+    {
+    }
+
+    state_id ngraph::add_state()
+    {
+        states_.emplace_back();
+
+        return static_cast<state_id>( states_.size() - 1 );
+    }
+
+    void ngraph::connect( state_id source, state_id target, nstate::transition_label_type lower,
+                          nstate::transition_label_type upper )
+    {
+        transitions_.push_back( { source, lower, upper, target } );
+        compact_ = false;
+    }
+
+    void ngraph::connect( state_id source, state_id target )
+    {
+        epsilons_.push_back( { source, target } );
+        compact_ = false;
+    }
 
-    const nstate::transition_label_type nstate::epsilon = 0x01;
+    void ngraph::connect_tagged( state_id source, state_id target, std::uint32_t tag )
+    {
+        epsilons_.push_back( { source, target, tag } );
+        compact_ = false;
+    }
 
-    void nstate::connect( nstate *target, transition_label_type transition_label )
+    state_id ngraph::splice( const ngraph &other )
     {
-        transitions_[transition_label].insert( target );
+        const auto state_offset = static_cast<state_id>( states_.size() );
+        const auto transition_offset = static_cast<std::uint32_t>( transitions_.size() );
+        const auto epsilon_offset = static_cast<std::uint32_t>( epsilons_.size() );
+
+        /*
+         * Grow geometrically, as an exact reservation would reallocate on every splice of a long chain
+         */
+        auto reserve = []( auto &destination, const auto &source ) {
+            if ( destination.size() + source.size() > destination.capacity() )
+            {
+                destination.reserve( std::max( destination.capacity() * 2, destination.size() + source.size() ) );
+            }
+        };
+
+        reserve( states_, other.states_ );
+        reserve( transitions_, other.transitions_ );
+        reserve( epsilons_, other.epsilons_ );
+
+        for ( auto st : other.states_ )
+        {
+            st.transitions_begin_ += transition_offset;
+            st.transitions_end_ += transition_offset;
+            st.epsilons_begin_ += epsilon_offset;
+            st.epsilons_end_ += epsilon_offset;
+            states_.push_back( st );
+        }
+
+        for ( const auto &t : other.transitions_ )
+        {
+            transitions_.push_back( { t.source + state_offset, t.lower, t.upper, t.target + state_offset } );
+        }
+
+        for ( const auto &e : other.epsilons_ )
+        {
+            epsilons_.push_back( { e.source + state_offset, e.target + state_offset, e.tag } );
+        }
+        /*
+         * The spliced transitions all follow the existing ones, so grouping is preserved
+         */
+        compact_ = compact_ && other.compact_;
+
+        return state_offset;
     }
 
-    const nstate::transitions_type &nstate::transitions() const
+    void ngraph::compact()
+    {
+        if ( compact_ )
+        {
+            return;
+        }
+
+        auto group = [this]( auto &transitions, std::uint32_t nstate::*begin, std::uint32_t nstate::*end ) {
+            for ( auto &st : states_ )
+            {
+                st.*begin = 0;
+                st.*end = 0;
+            }
+
+            for ( const auto &t : transitions )
+            {
+                ++( states_[t.source].*end );
+            }
+
+            std::uint32_t offset = 0;
+
+            for ( auto &st : states_ )
+            {
+                st.*begin = offset;
+                offset += st.*end;
+                st.*end = st.*begin;
+            }
+
+            std::remove_reference_t<decltype( transitions )> grouped( transitions.size(), transitions.get_allocator() );
+
+            for ( const auto &t : transitions )
+            {
+                grouped[( states_[t.source].*end )++] = t;
+            }
+
+            transitions.swap( grouped );
+        };
+
+        group( transitions_, &nstate::transitions_begin_, &nstate::transitions_end_ );
+        group( epsilons_, &nstate::epsilons_begin_, &nstate::epsilons_end_ );
+
+        compact_ = true;
+    }
+
+    std::span<const nstate::transition> ngraph::transitions( state_id state ) const
+    {
+        const auto &st = states_[state];
+
+        return { transitions_.data() + st.transitions_begin_, transitions_.data() + st.transitions_end_ };
+    }
+
+    std::span<const nstate::transition> ngraph::transitions() const
     {
         return transitions_;
     }
 
-    bool execute_internal(
-        const nstate *state, const nstate *finish, std::basic_string_view<nstate::transition_label_type> target,
-        std::vector<std::pair<const nstate *, std::basic_string_view<nstate::transition_label_type>>> &visited )
+    std::span<const nstate::epsilon> ngraph::epsilons( state_id state ) const
     {
-        if ( std::find_if( std::cbegin( visited ), std::cend( visited ), [state, target]( const auto &visit ) {
-                 return ( visit.first == state && visit.second == target );
-             } ) != std::cend( visited ) )
+        const auto &st = states_[state];
+
+        return { epsilons_.data() + st.epsilons_begin_, epsilons_.data() + st.epsilons_end_ };
+    }
+
+    std::span<const nstate::epsilon> ngraph::epsilons() const
+    {
+        return epsilons_;
+    }
+
+    std::size_t ngraph::size() const
+    {
+        return states_.size();
+    }
+
+    std::size_t ngraph::bytes() const
+    {
+        return states_.capacity() * sizeof( nstate ) + transitions_.capacity() * sizeof( nstate::transition ) +
+               epsilons_.capacity() * sizeof( nstate::epsilon );
+    }
+
+    std::pmr::memory_resource *ngraph::resource() const
+    {
+        return states_.get_allocator().resource();
+    }
+
+    sparse_set::sparse_set( std::size_t capacity )
+        : dense_( capacity )
+        , sparse_( capacity )
+    {
+    }
+
+    bool sparse_set::insert( state_id state )
+    {
+        if ( contains( state ) )
         {
             return false;
         }
 
-        visited.push_back( { state, target } );
+        sparse_[state] = size_;
+        dense_[size_++] = state;
+
+        return true;
+    }
 
-        if ( target.empty() )
+    bool sparse_set::contains( state_id state ) const
+    {
+        return sparse_[state] < size_ && dense_[sparse_[state]] == state;
+    }
+
+    void sparse_set::clear()
+    {
+        size_ = 0;
+    }
+
+    std::span<const state_id> sparse_set::states() const
+    {
+        return { dense_.data(), size_ };
+    }
+
+    /*
+     * Add state and everything reachable from it through null transitions
+     */
+    static void add_closure( const ngraph &graph, state_id state, sparse_set &states, std::vector<state_id> &pending )
+    {
+        if ( !states.insert( state ) )
+        {
+            return;
+        }
+
+        pending.push_back( state );
+
+        while ( !pending.empty() )
         {
-            if ( state == finish )
+            const auto current = pending.back();
+            pending.pop_back();
+
+            for ( const auto &e : graph.epsilons( current ) )
             {
-                return true;
+                if ( states.insert( e.target ) )
+                {
+                    pending.push_back( e.target );
+                }
             }
         }
+    }
 
-        const auto next_etransitions = state->transitions().find( nstate::epsilon );
+    nsimulation::nsimulation( const ngraph &graph, state_id start, state_id finish )
+        : graph_( graph ), start_( start ), finish_( finish ), size_( graph.size() ), current_( size_ ), next_( size_ )
+    {
+        reset();
+    }
 
-        if ( next_etransitions != std::cend( state->transitions() ) )
+    void nsimulation::reset()
+    {
+        current_.clear();
+        add_closure( graph_, start_, current_, pending_ );
+    }
+
+    bool nsimulation::advance( std::basic_string_view<language::character_type> target )
+    {
+        std::uint64_t read = 0, taken = 0;
+        metrics::histogram active;
+
+        for ( const auto character : target )
         {
-            for ( const auto next : next_etransitions->second )
+            const auto label = static_cast<nstate::transition_label_type>( character );
+
+            active.count( current_.states().size() );
+            next_.clear();
+            ++read;
+
+            for ( const auto st : current_.states() )
             {
-                if ( execute_internal( next, finish, target, visited ) )
+                for ( const auto &t : graph_.transitions( st ) )
                 {
-                    return true;
+                    if ( t.lower <= label && label <= t.upper )
+                    {
+                        ++taken;
+                        add_closure( graph_, t.target, next_, pending_ );
+                    }
                 }
             }
+
+            std::swap( current_, next_ );
+
+            if ( current_.states().empty() )
+            {
+                break;
+            }
         }
 
-        if ( !target.empty() )
+        metrics::add( metrics::counter::bytes, read );
+        metrics::add( metrics::counter::transitions, taken );
+        metrics::add( active );
+
+        return !current_.states().empty();
+    }
+
+    bool nsimulation::accepted() const
+    {
+        return current_.contains( finish_ );
+    }
+
+    bool nsimulation::simulates( const ngraph &graph, state_id start, state_id finish ) const
+    {
+        return &graph_ == &graph && size_ == graph.size() && start_ == start && finish_ == finish;
+    }
+
+    bool execute( const ngraph &graph, state_id start, state_id finish,
+                  std::basic_string_view<language::character_type> target )
+    {
+        nsimulation simulation( graph, start, finish );
+
+        return simulation.advance( target ) && simulation.accepted();
+    }
+
+    std::optional<std::vector<std::size_t>> capture( const ngraph &graph, state_id start, state_id finish,
+                                                     std::size_t slots,
+                                                     std::basic_string_view<language::character_type> target )
+    {
+        /*
+         * Threads in priority order, each with the capture slots recorded on its path
+         */
+        sparse_set current( graph.size() ), next( graph.size() );
+        std::vector<std::size_t> current_slots( graph.size() * slots ), next_slots( graph.size() * slots );
+        std::vector<std::size_t> path( slots, unset );
+        /*
+         * Depth first search of the null transitions, each frame either visiting a state after recording its tag
+         * or restoring a slot once everything reached through the tag has been visited
+         */
+        struct frame
         {
-            const auto next_transitions = state->transitions().find( target[0] );
+            state_id state;
+            std::uint32_t tag;
+            std::size_t restore;
+        };
+        std::vector<frame> pending;
+
+        auto add = [&]( state_id state, std::size_t position, sparse_set &threads, std::vector<std::size_t> &slot_of ) {
+            pending.push_back( { state, nstate::untagged, unset } );
 
-            if ( next_transitions != std::cend( state->transitions() ) )
+            while ( !pending.empty() )
             {
-                for ( const auto next : next_transitions->second )
+                const frame f = pending.back();
+                pending.pop_back();
+
+                if ( f.state == std::numeric_limits<state_id>::max() )
+                {
+                    path[f.tag] = f.restore;
+                    continue;
+                }
+
+                if ( f.tag != nstate::untagged )
+                {
+                    pending.push_back( { std::numeric_limits<state_id>::max(), f.tag, path[f.tag] } );
+                    path[f.tag] = position;
+                }
+
+                if ( !threads.insert( f.state ) )
+                {
+                    continue;
+                }
+
+                std::copy( std::cbegin( path ), std::cend( path ), std::begin( slot_of ) + f.state * slots );
+
+                const auto epsilons = graph.epsilons( f.state );
+
+                for ( auto e = std::crbegin( epsilons ); e != std::crend( epsilons ); ++e )
                 {
-                    if ( execute_internal( next, finish, target.substr( 1 ), visited ) )
+                    pending.push_back( { e->target, e->tag, unset } );
+                }
+            }
+        };
+
+        add( start, 0, current, current_slots );
+
+        std::uint64_t taken = 0;
+        metrics::histogram active;
+
+        for ( std::size_t position = 0; position < target.size(); ++position )
+        {
+            const auto label = static_cast<nstate::transition_label_type>( target[position] );
+
+            active.count( current.states().size() );
+            next.clear();
+
+            for ( const auto st : current.states() )
+            {
+                for ( const auto &t : graph.transitions( st ) )
+                {
+                    if ( t.lower <= label && label <= t.upper )
                     {
-                        return true;
+                        ++taken;
+
+                        const auto recorded = std::cbegin( current_slots ) + st * slots;
+                        std::copy( recorded, recorded + slots, std::begin( path ) );
+                        add( t.target, position + 1, next, next_slots );
                     }
                 }
             }
+
+            std::swap( current, next );
+            std::swap( current_slots, next_slots );
+
+            if ( current.states().empty() )
+            {
+                metrics::add( metrics::counter::bytes, position + 1 );
+                metrics::add( metrics::counter::transitions, taken );
+                metrics::add( active );
+
+                return std::nullopt;
+            }
         }
 
-        visited.pop_back();
+        metrics::add( metrics::counter::bytes, target.size() );
+        metrics::add( metrics::counter::transitions, taken );
+        metrics::add( active );
 
-        return false;
-    };
+        if ( !current.contains( finish ) )
+        {
+            return std::nullopt;
+        }
 
-    bool execute( const nstate *start, const nstate *finish,
-                  std::basic_string_view<nstate::transition_label_type> target )
-    {
-        std::vector<std::pair<const nstate *, std::basic_string_view<nstate::transition_label_type>>> visited;
+        const auto recorded = std::cbegin( current_slots ) + finish * slots;
 
-        return execute_internal( start, finish, target, visited );
+        return std::vector<std::size_t>( recorded, recorded + slots );
     }
-} // namespace regex::state
\ No newline at end of file
+} // namespace regex::state
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "regex/state/onepass.h"
+#include "regex/utilities/metrics.h"
+
+namespace regex::state
+{
+    onepass::onepass( std::size_t slots )
+        : slots_( slots ), tags_{ 0 }
+    {
+    }
+
+    std::optional<onepass> onepass::build( const ngraph &graph, state_id start, state_id finish, std::size_t slots )
+    {
+        onepass result( slots );
+        /*
+         * States of the graph in the order they became states of this automaton
+         */
+        std::vector<state_id> states{ start };
+        std::vector<std::uint32_t> index_of( graph.size(), none );
+        index_of[start] = 0;
+
+        /*
+         * Tags on the path by which each state of a closure was first reached, and the generation of the
+         * closure in which it was, avoiding a clear per closure
+         */
+        std::vector<std::vector<std::uint32_t>> reached_with( graph.size() );
+        std::vector<std::uint32_t> reached( graph.size(), none );
+        std::vector<std::pair<state_id, std::vector<std::uint32_t>>> pending;
+
+        auto intern_tags = [&result]( const std::vector<std::uint32_t> &tags ) -> std::uint32_t {
+            if ( tags.empty() )
+            {
+                return 0;
+            }
+
+            const auto offset = static_cast<std::uint32_t>( result.tags_.size() );
+            result.tags_.push_back( static_cast<std::uint32_t>( tags.size() ) );
+            result.tags_.insert( std::end( result.tags_ ), std::cbegin( tags ), std::cend( tags ) );
+
+            return offset;
+        };
+
+        auto same_tags = [&result]( std::uint32_t offset, const std::vector<std::uint32_t> &tags ) {
+            const auto count = result.tags_[offset];
+
+            return count == tags.size() && std::equal( std::cbegin( tags ), std::cend( tags ),
+                                                       std::cbegin( result.tags_ ) + offset + 1 );
+        };
+
+        for ( std::uint32_t index = 0; index < states.size(); ++index )
+        {
+            result.transitions_.resize( result.transitions_.size() + 256 );
+            result.accepts_.push_back( none );
+
+            pending.emplace_back( states[index], std::vector<std::uint32_t>() );
+
+            while ( !pending.empty() )
+            {
+                auto [current, tags] = std::move( pending.back() );
+                pending.pop_back();
+
+                if ( reached[current] == index )
+                {
+                    /*
+                     * Reaching a state again is harmless only if it records the same positions
+                     */
+                    if ( reached_with[current] != tags )
+                    {
+                        return std::nullopt;
+                    }
+
+                    continue;
+                }
+
+                reached[current] = index;
+                reached_with[current] = tags;
+
+                if ( current == finish )
+                {
+                    if ( result.accepts_[index] != none )
+                    {
+                        return std::nullopt;
+                    }
+
+                    result.accepts_[index] = intern_tags( tags );
+                }
+
+                const auto labelled = graph.transitions( current );
+                const auto recorded = labelled.empty() ? 0 : intern_tags( tags );
+
+                for ( const auto &t : labelled )
+                {
+                    if ( index_of[t.target] == none )
+                    {
+                        if ( states.size() == state_limit )
+                        {
+                            return std::nullopt;
+                        }
+
+                        index_of[t.target] = static_cast<std::uint32_t>( states.size() );
+                        states.push_back( t.target );
+                    }
+
+                    for ( unsigned character = t.lower; character <= t.upper; ++character )
+                    {
+                        auto &a = result.transitions_[index * 256 + character];
+
+                        if ( a.next != none && ( a.next != index_of[t.target] || !same_tags( a.tags, tags ) ) )
+                        {
+                            return std::nullopt;
+                        }
+
+                        a = { index_of[t.target], recorded };
+                    }
+                }
+
+                for ( const auto &e : graph.epsilons( current ) )
+                {
+                    auto path = tags;
+
+                    if ( e.tag != nstate::untagged )
+                    {
+                        path.push_back( e.tag );
+                    }
+
+                    pending.emplace_back( e.target, std::move( path ) );
+                }
+            }
+        }
+
+        return result;
+    }
+
+    std::optional<std::vector<std::size_t>> onepass::capture(
+        std::basic_string_view<language::character_type> target ) const
+    {
+        std::vector<std::size_t> slots( slots_, unset );
+        std::uint32_t current = 0;
+
+        auto record = [this, &slots]( std::uint32_t offset, std::size_t position ) {
+            const auto count = tags_[offset];
+
+            for ( std::uint32_t i = 1; i <= count; ++i )
+            {
+                slots[tags_[offset + i]] = position;
+            }
+        };
+
+        for ( std::size_t position = 0; position < target.size(); ++position )
+        {
+            const auto &a = transitions_[current * 256 + static_cast<unsigned char>( target[position] )];
+
+            if ( a.next == none )
+            {
+                metrics::add( metrics::counter::bytes, position + 1 );
+                metrics::add( metrics::counter::transitions, position );
+
+                return std::nullopt;
+            }
+
+            record( a.tags, position );
+            current = a.next;
+        }
+
+        metrics::add( metrics::counter::bytes, target.size() );
+        metrics::add( metrics::counter::transitions, target.size() );
+
+        if ( accepts_[current] == none )
+        {
+            return std::nullopt;
+        }
+
+        record( accepts_[current], target.size() );
+
+        return slots;
+    }
+
+    std::size_t onepass::size() const
+    {
+        return accepts_.size();
+    }
+} // namespace regex::state
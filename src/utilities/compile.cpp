@@ -1,32 +1,209 @@
+#include <chrono>
+#include <limits>
+#include <memory_resource>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "regex/automata/dfa.h"
 #include "regex/automata/nfa.h"
+#include "regex/automata/pattern_set.h"
 #include "regex/language/ast.h"
 #include "regex/language/parser.h"
+#include "regex/language/simplify.h"
+#include "regex/memory/arena.h"
 #include "regex/utilities/compile.h"
 
 namespace regex
 {
-    std::unique_ptr<regex::nfa> compile_nfa( std::basic_string_view<language::character_type> expression )
+    /*
+     * Every temporary of a compile, from the ast to the subset construction, is allocated from one arena
+     * which is released as a whole once the automaton has been copied out of it. The first chunk holds the
+     * tokens and three times as much again for states, so most compiles need a single chunk.
+     */
+    static std::size_t scratch_size( std::basic_string_view<language::character_type> expression )
     {
-        return compile_nfa( language::parse<pool_allocator<language::token>>( expression ) );
+        return language::ast<>::capacity( expression ) * sizeof( language::token ) * 4;
     }
 
-    std::unique_ptr<regex::dfa> compile_dfa( std::basic_string_view<language::character_type> expression )
+    /*
+     * Whether the ast is made of nothing but characters, concatenations, alternations and groups
+     */
+    template <typename Allocator>
+    static bool literal( const language::ast<Allocator> &a )
     {
-        return compile_dfa( language::parse<pool_allocator<language::token>>( expression ) );
+        bool result = true;
+
+        a.postfix( [&result]( const language::token &t ) {
+            switch( t.character )
+            {
+            case '.':
+            case '*':
+            case '?':
+            case '+':
+            case '[':
+            case '{':
+                result = false;
+                break;
+            default:
+                break;
+            }
+        } );
+
+        return result;
+    }
+
+    std::unique_ptr<regex::nfa> compile_nfa( std::basic_string_view<language::character_type> expression,
+                                             language::syntax_flag flags )
+    {
+        memory::arena scratch( scratch_size( expression ) );
+        auto a = language::parse( expression, std::pmr::polymorphic_allocator<language::token>( &scratch ),
+                                  flags );
+        language::simplify( a );
+
+        return std::make_unique<regex::nfa>( *compile_nfa( a, &scratch ) );
+    }
+
+    std::unique_ptr<regex::nfa> compile_captures( std::basic_string_view<language::character_type> expression,
+                                                  language::syntax_flag flags )
+    {
+        memory::arena scratch( scratch_size( expression ) );
+        const auto a =
+            language::parse( expression, std::pmr::polymorphic_allocator<language::token>( &scratch ), flags );
+
+        return std::make_unique<regex::nfa>( *compile_nfa( a, &scratch ) );
+    }
+
+    std::unique_ptr<regex::dfa> compile_dfa( std::basic_string_view<language::character_type> expression,
+                                             language::syntax_flag flags )
+    {
+        memory::arena scratch( scratch_size( expression ) );
+        auto a = language::parse( expression, std::pmr::polymorphic_allocator<language::token>( &scratch ),
+                                  flags );
+        language::simplify( a );
+
+        return compile_nfa( a, &scratch )->to_dfa( &scratch );
+    }
+
+    std::unique_ptr<regex::pattern_set>
+    compile_patterns( const std::vector<std::basic_string<language::character_type>> &expressions,
+                      language::syntax_flag flags )
+    {
+        std::vector<std::unique_ptr<regex::nfa>> patterns;
+
+        patterns.reserve( expressions.size() );
+
+        for( std::size_t i = 0; i < expressions.size(); ++i )
+        {
+            if( expressions[i].empty() )
+            {
+                patterns.push_back( nfa::from_epsilon() );
+                continue;
+            }
+
+            try
+            {
+                patterns.push_back( compile_nfa( expressions[i], flags ) );
+            }
+            catch( const std::runtime_error &e )
+            {
+                throw std::runtime_error( "Pattern " + std::to_string( i + 1 ) + ": " + e.what() );
+            }
+        }
+
+        return std::make_unique<regex::pattern_set>( patterns );
     }
 
-    std::unique_ptr<regex::fa> compile( std::basic_string_view<language::character_type> expression, compile_flag flag )
+    std::unique_ptr<regex::fa> compile( std::basic_string_view<language::character_type> expression, compile_flag flag,
+                                        language::syntax_flag flags )
     {
-        if( flag == compile_flag::nfa )
+        switch( flag )
         {
-            return compile_nfa( expression );
+        case compile_flag::nfa:
+            return compile_nfa( expression, flags );
+        case compile_flag::dfa:
+            return compile_dfa( expression, flags );
+        default: {
+            compile_stats stats;
+            return compile( expression, flag, flags, stats );
         }
-        else
+        }
+    }
+
+    std::unique_ptr<regex::fa> compile( std::basic_string_view<language::character_type> expression, compile_flag flag,
+                                        language::syntax_flag flags, compile_stats &stats )
+    {
+        using clock = std::chrono::steady_clock;
+
+        stats = compile_stats();
+
+        memory::arena scratch( scratch_size( expression ) );
+        auto start = clock::now();
+
+        auto a = language::parse( expression, std::pmr::polymorphic_allocator<language::token>( &scratch ),
+                                  flags );
+        stats.parse_time = clock::now() - start;
+
+        start = clock::now();
+        language::simplify( a );
+        stats.simplify_time = clock::now() - start;
+
+        a.postfix( [&stats]( const language::token & ) { ++stats.ast_nodes; } );
+
+        start = clock::now();
+        auto n = compile_nfa( a, &scratch );
+        stats.nfa_time = clock::now() - start;
+        stats.nfa_states = n->size();
+        stats.nfa_transitions = n->transitions();
+        stats.nfa_bytes = n->bytes();
+
+        std::unique_ptr<regex::dfa> deterministic;
+        stats.engine = flag;
+
+        if( flag == compile_flag::automatic )
         {
-            return compile_dfa( expression );
+            start = clock::now();
+            deterministic = n->to_dfa( &scratch, literal( a ) ? std::numeric_limits<std::size_t>::max()
+                                                                : automatic_budget );
+            stats.dfa_time = clock::now() - start;
+            stats.engine = deterministic ? compile_flag::dfa : compile_flag::lazy;
         }
+
+        if( stats.engine == compile_flag::nfa || stats.engine == compile_flag::lazy )
+        {
+            start = clock::now();
+            std::unique_ptr<regex::fa> result;
+            const auto bytes = n->bytes();
+
+            if( stats.engine == compile_flag::nfa )
+            {
+                result = std::make_unique<regex::nfa>( *n );
+            }
+            else
+            {
+                std::vector<std::unique_ptr<regex::nfa>> patterns;
+                patterns.push_back( std::move( n ) );
+                result = std::make_unique<regex::pattern_set>( patterns );
+            }
+
+            stats.nfa_time += clock::now() - start;
+            stats.peak_bytes = scratch.reserved() + bytes;
+
+            return result;
+        }
+
+        if( !deterministic )
+        {
+            start = clock::now();
+            deterministic = n->to_dfa( &scratch );
+            stats.dfa_time = clock::now() - start;
+        }
+
+        stats.dfa_states = deterministic->size();
+        stats.dfa_bytes = deterministic->bytes();
+        stats.peak_bytes = scratch.reserved() + stats.dfa_bytes;
+
+        return deterministic;
     }
 } // namespace regex
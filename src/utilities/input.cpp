@@ -0,0 +1,128 @@
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "regex/utilities/input.h"
+
+namespace regex
+{
+    input::input( const std::filesystem::path &path, language::character_type delimiter )
+        : descriptor_( path == "-" ? STDIN_FILENO : ::open( path.c_str(), O_RDONLY ) ), delimiter_( delimiter )
+    {
+        if ( descriptor_ < 0 )
+        {
+            throw std::system_error( errno, std::generic_category(), path.string() );
+        }
+
+        struct stat status;
+
+        if ( ::fstat( descriptor_, &status ) == 0 && S_ISREG( status.st_mode ) && status.st_size > 0 )
+        {
+            void *mapping = ::mmap( nullptr, static_cast<std::size_t>( status.st_size ), PROT_READ, MAP_PRIVATE,
+                                    descriptor_, 0 );
+
+            if ( mapping != MAP_FAILED )
+            {
+                mapping_ = mapping;
+                mapping_size_ = static_cast<std::size_t>( status.st_size );
+                ::madvise( mapping_, mapping_size_, MADV_SEQUENTIAL );
+                return;
+            }
+        }
+
+        buffer_.resize( buffer_size );
+    }
+
+    input::~input()
+    {
+        if ( mapping_ )
+        {
+            ::munmap( mapping_, mapping_size_ );
+        }
+
+        if ( descriptor_ != STDIN_FILENO )
+        {
+            ::close( descriptor_ );
+        }
+    }
+
+    bool input::mapped() const
+    {
+        return mapping_ != nullptr;
+    }
+
+    std::basic_string_view<language::character_type> input::next()
+    {
+        if ( mapping_ )
+        {
+            if ( mapping_consumed_ )
+            {
+                return {};
+            }
+
+            mapping_consumed_ = true;
+
+            return { static_cast<const language::character_type *>( mapping_ ), mapping_size_ };
+        }
+
+        /*
+         * Move the record cut by the last read to the front, making room to complete it
+         */
+        std::memmove( buffer_.data(), buffer_.data() + begin_, end_ - begin_ );
+        end_ -= begin_;
+        begin_ = 0;
+
+        while ( !exhausted_ )
+        {
+            if ( end_ == buffer_.size() )
+            {
+                buffer_.resize( buffer_.size() * 2 );
+            }
+
+            const auto count = ::read( descriptor_, buffer_.data() + end_, buffer_.size() - end_ );
+
+            if ( count < 0 )
+            {
+                if ( errno == EINTR )
+                {
+                    continue;
+                }
+
+                throw std::system_error( errno, std::generic_category(), "read" );
+            }
+
+            if ( count == 0 )
+            {
+                exhausted_ = true;
+                break;
+            }
+
+            const auto searched = end_;
+            end_ += static_cast<std::size_t>( count );
+
+            /*
+             * The last record of a read is rarely long, so searching backwards finds its start quickly
+             */
+            const auto last = std::basic_string_view<language::character_type>( buffer_.data() + searched,
+                                                                                 end_ - searched )
+                                  .find_last_of( delimiter_ );
+
+            if ( last != std::basic_string_view<language::character_type>::npos )
+            {
+                begin_ = searched + last + 1;
+
+                return { buffer_.data(), begin_ };
+            }
+        }
+
+        begin_ = end_;
+
+        return { buffer_.data(), end_ };
+    }
+} // namespace regex
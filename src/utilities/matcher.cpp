@@ -0,0 +1,69 @@
+#include <cstring>
+#include <utility>
+
+#include "regex/utilities/matcher.h"
+
+namespace regex
+{
+    matcher::matcher( fa &automata, callback_type on_match, std::optional<language::character_type> delimiter )
+        : cursor_( automata.make_cursor() ), on_match_( std::move( on_match ) ), delimiter_( delimiter )
+    {
+    }
+
+    void matcher::feed( std::basic_string_view<language::character_type> chunk )
+    {
+        while ( !chunk.empty() )
+        {
+            const void *end = delimiter_ ? std::memchr( chunk.data(), *delimiter_, chunk.size() ) : nullptr;
+            const std::size_t length =
+                end ? static_cast<std::size_t>( static_cast<const language::character_type *>( end ) - chunk.data() )
+                    : chunk.size();
+
+            if ( alive_ )
+            {
+                alive_ = cursor_->advance( chunk.substr( 0, length ) );
+            }
+
+            offset_ += length;
+
+            if ( !end )
+            {
+                break;
+            }
+
+            end_record();
+
+            ++offset_;
+            record_ = offset_;
+            chunk.remove_prefix( length + 1 );
+        }
+    }
+
+    void matcher::finish()
+    {
+        if ( !delimiter_ || offset_ > record_ )
+        {
+            end_record();
+        }
+
+        offset_ = record_ = 0;
+        cursor_->reset();
+        alive_ = true;
+    }
+
+    matcher::offset_type matcher::offset() const
+    {
+        return offset_;
+    }
+
+    void matcher::end_record()
+    {
+        if ( alive_ && cursor_->accepted() )
+        {
+            on_match_( record_, offset_ );
+        }
+
+        cursor_->reset();
+        alive_ = true;
+    }
+} // namespace regex
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "regex/utilities/metrics.h"
+
+namespace regex::metrics
+{
+    namespace
+    {
+        /*
+         * Blocks of the live threads, and the totals of those which have finished
+         */
+        struct registry
+        {
+            std::mutex mutex;
+            std::vector<detail::block *> blocks;
+            snapshot retired;
+        };
+
+        registry &blocks()
+        {
+            static registry r;
+            return r;
+        }
+
+        void accumulate( snapshot &s, const detail::block &b )
+        {
+            for ( std::size_t i = 0; i < counters; ++i )
+            {
+                s.values[i] += b.values[i].load( std::memory_order_relaxed );
+            }
+
+            for ( std::size_t i = 0; i < buckets; ++i )
+            {
+                s.active_states[i] += b.active_states[i].load( std::memory_order_relaxed );
+            }
+
+            s.active_states_sum += b.active_states_sum.load( std::memory_order_relaxed );
+        }
+    } // namespace
+
+    detail::block::block()
+    {
+        auto &r = blocks();
+        std::lock_guard lock( r.mutex );
+
+        r.blocks.push_back( this );
+    }
+
+    detail::block::~block()
+    {
+        auto &r = blocks();
+        std::lock_guard lock( r.mutex );
+
+        accumulate( r.retired, *this );
+        r.blocks.erase( std::find( std::begin( r.blocks ), std::end( r.blocks ), this ) );
+    }
+
+    snapshot collect()
+    {
+        auto &r = blocks();
+        std::lock_guard lock( r.mutex );
+        snapshot result = r.retired;
+
+        for ( const auto *b : r.blocks )
+        {
+            accumulate( result, *b );
+        }
+
+        return result;
+    }
+
+    void write( std::ostream &output, const snapshot &s, const char *prefix )
+    {
+        static constexpr const char *names[counters]{ "bytes_total", "transitions_total", "cache_misses_total",
+                                                      "cache_resets_total" };
+
+        for ( std::size_t i = 0; i < counters; ++i )
+        {
+            output << "# TYPE " << prefix << names[i] << " counter\n" << prefix << names[i] << ' ' << s.values[i]
+                   << '\n';
+        }
+        /*
+         * Histogram buckets are cumulative, each counting every character read with at most le states active
+         */
+        std::uint64_t cumulative = 0;
+
+        output << "# TYPE " << prefix << "active_states histogram\n";
+
+        for ( std::size_t i = 0; i < buckets; ++i )
+        {
+            cumulative += s.active_states[i];
+            output << prefix << "active_states_bucket{le=\"";
+
+            if ( i + 1 < buckets )
+            {
+                output << ( ( std::uint64_t{ 1 } << ( i + 1 ) ) - 1 );
+            }
+            else
+            {
+                output << "+Inf";
+            }
+
+            output << "\"} " << cumulative << '\n';
+        }
+
+        output << prefix << "active_states_sum " << s.active_states_sum << '\n';
+        output << prefix << "active_states_count " << cumulative << '\n';
+    }
+} // namespace regex::metrics
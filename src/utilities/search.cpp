@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "regex/utilities/search.h"
+
+namespace regex
+{
+    searcher::searcher( fa &automata, std::ostream &output, search_options options )
+        : automata_( automata ), output_( output ), options_( options )
+    {
+        if ( options_.threads > 1 )
+        {
+            pool_ = std::make_unique<thread_pool>( options_.threads );
+        }
+
+        for ( std::size_t i = 0; i < ( pool_ ? pool_->size() : 1 ); ++i )
+        {
+            cursors_.push_back( automata_.make_cursor() );
+        }
+    }
+
+    searcher::searcher( pattern_set &patterns, std::ostream &output, search_options options )
+        : searcher( static_cast<fa &>( patterns ), output, options )
+    {
+        patterns_ = &patterns;
+    }
+
+    bool searcher::search( const std::vector<std::filesystem::path> &targets, std::ostream &errors )
+    {
+        errors_ = &errors;
+        failed_ = false;
+        stopped_ = false;
+        matches_ = bytes_ = lines_ = 0;
+
+        for ( const auto &target : targets )
+        {
+            if ( stopped_ )
+            {
+                break;
+            }
+
+            std::error_code error;
+
+            if ( target != "-" && std::filesystem::is_directory( target, error ) )
+            {
+                auto entry = std::filesystem::recursive_directory_iterator(
+                    target, std::filesystem::directory_options::skip_permission_denied, error );
+
+                for ( ; !error && !stopped_ && entry != std::filesystem::recursive_directory_iterator();
+                      entry.increment( error ) )
+                {
+                    if ( entry->is_regular_file( error ) )
+                    {
+                        search_file( entry->path() );
+                    }
+                }
+
+                if ( error )
+                {
+                    fail( target.string() + ": " + error.message() );
+                }
+            }
+            else
+            {
+                search_file( target );
+            }
+        }
+
+        flush( 0 );
+
+        return !failed_;
+    }
+
+    std::uint64_t searcher::matches() const
+    {
+        return matches_;
+    }
+
+    std::uint64_t searcher::bytes() const
+    {
+        return bytes_;
+    }
+
+    std::uint64_t searcher::lines() const
+    {
+        return lines_;
+    }
+
+    void searcher::search_file( const std::filesystem::path &path )
+    {
+        std::shared_ptr<input> source;
+
+        try
+        {
+            source = std::make_shared<input>( path );
+        }
+        catch ( const std::system_error &e )
+        {
+            fail( e.what() );
+            return;
+        }
+
+        auto f = std::make_shared<file>();
+        f->path = path;
+
+        try
+        {
+            for ( auto block = source->next(); !block.empty() && !finished( *f ); block = source->next() )
+            {
+                /*
+                 * A block read from a pipe is overwritten by the next, so is copied if matched on another thread
+                 */
+                std::shared_ptr<const std::basic_string<language::character_type>> copy;
+
+                if ( pool_ && !source->mapped() )
+                {
+                    copy = std::make_shared<const std::basic_string<language::character_type>>( block );
+                    block = *copy;
+                }
+
+                while ( !block.empty() && !finished( *f ) )
+                {
+                    auto length = std::min( block.size(), options_.chunk_size );
+
+                    if ( length < block.size() )
+                    {
+                        const void *newline = std::memchr( block.data() + length, '\n', block.size() - length );
+
+                        length = newline ? static_cast<std::size_t>( static_cast<const language::character_type *>(
+                                                                         newline ) -
+                                                                     block.data() ) +
+                                               1
+                                         : block.size();
+                    }
+
+                    auto c = std::make_shared<chunk>();
+
+                    c->lines = block.substr( 0, length );
+                    c->source_file = f;
+                    c->source = source;
+                    c->copy = copy;
+
+                    block.remove_prefix( length );
+                    dispatch( std::move( c ) );
+                }
+
+                if ( !pool_ )
+                {
+                    flush( 0 );
+                }
+            }
+        }
+        catch ( const std::system_error &e )
+        {
+            fail( path.string() + ": " + e.what() );
+        }
+
+        auto summary = std::make_shared<chunk>();
+
+        summary->source_file = std::move( f );
+        summary->summary = true;
+        summary->done = true;
+        window_.push_back( std::move( summary ) );
+
+        if ( !pool_ )
+        {
+            flush( 0 );
+        }
+    }
+
+    bool searcher::finished( const file &f ) const
+    {
+        return stopped_ || ( options_.mode == search_mode::files && f.found ) ||
+               ( options_.max_count && f.reported >= options_.max_count );
+    }
+
+    void searcher::dispatch( std::shared_ptr<chunk> c )
+    {
+        window_.push_back( c );
+
+        if ( !pool_ )
+        {
+            match( *c );
+            c->done = true;
+            return;
+        }
+
+        pool_->submit( [this, c]() {
+            match( *c );
+
+            std::lock_guard lock( mutex_ );
+            c->done = true;
+            /*
+             * Notified under the lock, so the searcher cannot see the chunk done and be destroyed before
+             */
+            done_.notify_all();
+        } );
+        /*
+         * Enough chunks ahead of the one being written to keep every thread busy
+         */
+        flush( 4 * pool_->size() );
+    }
+
+    void searcher::fail( const std::string &error )
+    {
+        auto c = std::make_shared<chunk>();
+
+        c->error = error;
+        c->done = true;
+        window_.push_back( std::move( c ) );
+        failed_ = true;
+    }
+
+    void searcher::flush( std::size_t keep )
+    {
+        while ( !window_.empty() )
+        {
+            auto &c = *window_.front();
+
+            {
+                std::unique_lock lock( mutex_ );
+
+                if ( window_.size() > keep )
+                {
+                    done_.wait( lock, [&c]() { return c.done; } );
+                }
+                else if ( !c.done )
+                {
+                    return;
+                }
+            }
+
+            write( c );
+            window_.pop_front();
+        }
+    }
+
+    void searcher::write( chunk &c )
+    {
+        if ( !c.error.empty() )
+        {
+            *errors_ << c.error << '\n';
+            return;
+        }
+
+        auto &f = *c.source_file;
+
+        bytes_ += c.bytes_read;
+        lines_ += c.lines_read;
+
+        if ( c.summary )
+        {
+            if ( options_.mode == search_mode::count )
+            {
+                if ( options_.with_filename )
+                {
+                    output_ << f.path.string() << ':';
+                }
+
+                output_ << f.reported << '\n';
+            }
+            else if ( options_.mode == search_mode::files && f.reported > 0 )
+            {
+                output_ << f.path.string() << '\n';
+            }
+
+            return;
+        }
+        /*
+         * Chunks matched in parallel may find more than the lines left to report, so cut off those past the limit
+         */
+        auto matches = c.matches;
+
+        if ( options_.mode == search_mode::files || options_.mode == search_mode::quiet )
+        {
+            matches = std::min<std::uint64_t>( matches, f.reported == 0 ? 1 : 0 );
+        }
+        else if ( options_.max_count )
+        {
+            matches = std::min( matches, options_.max_count - std::min( f.reported, options_.max_count ) );
+        }
+
+        if ( options_.mode == search_mode::lines )
+        {
+            std::size_t length = 0;
+
+            for ( std::uint64_t i = 0; i < matches; ++i )
+            {
+                length = c.output.find( '\n', length ) + 1;
+            }
+
+            output_.write( c.output.data(), static_cast<std::streamsize>( length ) );
+        }
+
+        f.reported += matches;
+        matches_ += matches;
+    }
+
+    void searcher::match( chunk &c )
+    {
+        auto &f = *c.source_file;
+        const bool lines_mode = options_.mode == search_mode::lines;
+        const bool first_only = options_.mode == search_mode::files || options_.mode == search_mode::quiet;
+        const std::string prefix = options_.with_filename && lines_mode ? f.path.string() + ':' : std::string();
+        auto lines = c.lines;
+        std::unique_ptr<fa::cursor> cursor;
+
+        {
+            std::lock_guard lock( mutex_ );
+            cursor = std::move( cursors_.back() );
+            cursors_.pop_back();
+        }
+
+        while ( !lines.empty() )
+        {
+            /*
+             * Another chunk may already have answered for its file, or for the whole search
+             */
+            if ( stopped_.load( std::memory_order_relaxed ) ||
+                 ( first_only && f.found.load( std::memory_order_relaxed ) ) )
+            {
+                break;
+            }
+
+            const void *newline = std::memchr( lines.data(), '\n', lines.size() );
+            const std::size_t length =
+                newline ? static_cast<std::size_t>( static_cast<const language::character_type *>( newline ) -
+                                                    lines.data() )
+                        : lines.size();
+            const auto line = lines.substr( 0, length );
+
+            c.bytes_read += newline ? length + 1 : length;
+            ++c.lines_read;
+            cursor->reset();
+
+            if ( cursor->advance( line ) && cursor->accepted() )
+            {
+                ++c.matches;
+
+                if ( lines_mode )
+                {
+                    c.output += prefix;
+
+                    if ( patterns_ )
+                    {
+                        const auto &run = static_cast<const pattern_set::cursor &>( *cursor );
+                        const char *separator = "";
+
+                        for ( const auto id : run.patterns() )
+                        {
+                            c.output += separator;
+                            c.output += std::to_string( id + 1 );
+                            separator = ",";
+                        }
+
+                        c.output += ':';
+                    }
+
+                    c.output.append( line );
+                    c.output += '\n';
+                }
+
+                if ( first_only )
+                {
+                    f.found = true;
+
+                    if ( options_.mode == search_mode::quiet )
+                    {
+                        stopped_ = true;
+                    }
+
+                    break;
+                }
+
+                if ( c.matches == options_.max_count )
+                {
+                    break;
+                }
+            }
+
+            lines.remove_prefix( newline ? length + 1 : length );
+        }
+
+        {
+            std::lock_guard lock( mutex_ );
+            cursors_.push_back( std::move( cursor ) );
+        }
+
+        c.source.reset();
+        c.copy.reset();
+    }
+} // namespace regex
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <utility>
+
+#include "regex/utilities/thread_pool.h"
+
+namespace regex
+{
+    thread_pool::thread_pool( std::size_t threads )
+    {
+        threads = std::max<std::size_t>( threads, 1 );
+
+        for ( std::size_t i = 0; i < threads; ++i )
+        {
+            queues_.push_back( std::make_unique<queue>() );
+        }
+
+        for ( std::size_t i = 0; i < threads; ++i )
+        {
+            threads_.emplace_back( [this, i]() { work( i ); } );
+        }
+    }
+
+    thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard lock( mutex_ );
+            stopping_ = true;
+        }
+
+        wake_.notify_all();
+
+        for ( auto &thread : threads_ )
+        {
+            thread.join();
+        }
+    }
+
+    void thread_pool::submit( task_type task )
+    {
+        auto &q = *queues_[next_++ % queues_.size()];
+
+        {
+            std::lock_guard lock( q.mutex );
+            q.tasks.push_back( std::move( task ) );
+        }
+
+        {
+            std::lock_guard lock( mutex_ );
+            ++pending_;
+        }
+
+        wake_.notify_one();
+    }
+
+    std::size_t thread_pool::size() const
+    {
+        return threads_.size();
+    }
+
+    bool thread_pool::take( std::size_t index, task_type &task )
+    {
+        for ( std::size_t i = 0; i < queues_.size(); ++i )
+        {
+            auto &q = *queues_[( index + i ) % queues_.size()];
+            std::lock_guard lock( q.mutex );
+
+            if ( q.tasks.empty() )
+            {
+                continue;
+            }
+
+            /*
+             * A thread takes the oldest of its own tasks, but steals the newest of another's
+             */
+            if ( i == 0 )
+            {
+                task = std::move( q.tasks.front() );
+                q.tasks.pop_front();
+            }
+            else
+            {
+                task = std::move( q.tasks.back() );
+                q.tasks.pop_back();
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void thread_pool::work( std::size_t index )
+    {
+        task_type task;
+
+        for ( ;; )
+        {
+            {
+                std::unique_lock lock( mutex_ );
+                wake_.wait( lock, [this]() { return pending_ > 0 || stopping_; } );
+
+                if ( pending_ == 0 )
+                {
+                    return;
+                }
+
+                --pending_;
+            }
+            /*
+             * Every pending task is in some queue, so one is found even if another thread took the one submitted
+             */
+            while ( !take( index, task ) )
+            {
+            }
+
+            task();
+            task = nullptr;
+        }
+    }
+} // namespace regex
@@ -0,0 +1,142 @@
+#include "bm_allocations.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<std::uint64_t> made{ 0 };
+    std::atomic<std::uint64_t> allocated{ 0 };
+    std::atomic<std::uint64_t> live{ 0 };
+    std::atomic<std::uint64_t> peak{ 0 };
+    /*
+     * Each block is preceded by a header holding its size, as operator delete is not always told it
+     */
+    constexpr std::size_t header = alignof( std::max_align_t );
+
+    void *allocate( std::size_t size, std::size_t alignment )
+    {
+        const auto offset = std::max( header, alignment );
+        const auto total = ( size + offset + alignment - 1 ) / alignment * alignment;
+        auto *block = static_cast<char *>( alignment > header ? std::aligned_alloc( alignment, total )
+                                                              : std::malloc( size + offset ) );
+
+        if( !block )
+            throw std::bad_alloc();
+
+        auto *result = block + offset;
+        reinterpret_cast<std::size_t *>( result )[-1] = size;
+
+        made.fetch_add( 1, std::memory_order_relaxed );
+        allocated.fetch_add( size, std::memory_order_relaxed );
+
+        const auto held = live.fetch_add( size, std::memory_order_relaxed ) + size;
+        auto highest = peak.load( std::memory_order_relaxed );
+
+        while( held > highest && !peak.compare_exchange_weak( highest, held, std::memory_order_relaxed ) )
+            ;
+
+        return result;
+    }
+
+    void release( void *pointer, std::size_t alignment ) noexcept
+    {
+        if( !pointer )
+            return;
+
+        auto *result = static_cast<char *>( pointer );
+
+        live.fetch_sub( reinterpret_cast<std::size_t *>( result )[-1], std::memory_order_relaxed );
+        std::free( result - std::max( header, alignment ) );
+    }
+} // namespace
+
+void *operator new( std::size_t size )
+{
+    return allocate( size, header );
+}
+
+void *operator new[]( std::size_t size )
+{
+    return allocate( size, header );
+}
+
+void *operator new( std::size_t size, std::align_val_t alignment )
+{
+    return allocate( size, static_cast<std::size_t>( alignment ) );
+}
+
+void *operator new[]( std::size_t size, std::align_val_t alignment )
+{
+    return allocate( size, static_cast<std::size_t>( alignment ) );
+}
+
+void operator delete( void *pointer ) noexcept
+{
+    release( pointer, header );
+}
+
+void operator delete[]( void *pointer ) noexcept
+{
+    release( pointer, header );
+}
+
+void operator delete( void *pointer, std::size_t ) noexcept
+{
+    release( pointer, header );
+}
+
+void operator delete[]( void *pointer, std::size_t ) noexcept
+{
+    release( pointer, header );
+}
+
+void operator delete( void *pointer, std::align_val_t alignment ) noexcept
+{
+    release( pointer, static_cast<std::size_t>( alignment ) );
+}
+
+void operator delete[]( void *pointer, std::align_val_t alignment ) noexcept
+{
+    release( pointer, static_cast<std::size_t>( alignment ) );
+}
+
+void operator delete( void *pointer, std::size_t, std::align_val_t alignment ) noexcept
+{
+    release( pointer, static_cast<std::size_t>( alignment ) );
+}
+
+void operator delete[]( void *pointer, std::size_t, std::align_val_t alignment ) noexcept
+{
+    release( pointer, static_cast<std::size_t>( alignment ) );
+}
+
+namespace allocations
+{
+    scope::scope()
+        : live_( live.load( std::memory_order_relaxed ) )
+    {
+        peak.store( live_, std::memory_order_relaxed );
+        begin_ = { made.load( std::memory_order_relaxed ), allocated.load( std::memory_order_relaxed ), 0 };
+    }
+
+    counts scope::read() const
+    {
+        return { made.load( std::memory_order_relaxed ) - begin_.allocations,
+                 allocated.load( std::memory_order_relaxed ) - begin_.bytes,
+                 peak.load( std::memory_order_relaxed ) - live_ };
+    }
+
+    void scope::report( benchmark::State &state ) const
+    {
+        const auto c = read();
+
+        state.counters["allocations"] =
+            benchmark::Counter( static_cast<double>( c.allocations ), benchmark::Counter::kAvgIterations );
+        state.counters["allocated_bytes"] =
+            benchmark::Counter( static_cast<double>( c.bytes ), benchmark::Counter::kAvgIterations );
+        state.counters["peak_bytes"] = static_cast<double>( c.peak );
+    }
+} // namespace allocations
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "benchmark/benchmark.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Every allocation made by benchmark-regex goes through the global operator new of bm_allocations.cpp, which
+ * counts them. A scope reads the counts around the loop of a benchmark and reports them as counters, so that
+ * allocations on the match path show up, and are compared by compare_benchmarks.py, like time does
+ *
+ *      allocations     allocations per iteration
+ *      allocated_bytes bytes allocated per iteration
+ *      peak_bytes      most bytes held at once above those held when the scope began
+ *
+ *      allocations::scope counting;
+ *      for( auto _ : state ) { ... }
+ *      counting.report( state );
+ *
+ * Scopes count the allocations of every thread and do not nest.
+ */
+namespace allocations
+{
+    struct counts
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t peak = 0;
+    };
+
+    class scope
+    {
+      public:
+        scope();
+        /*
+         * Counts of the allocations made since the scope began
+         */
+        counts read() const;
+        /*
+         * Set the counters of state from the allocations made since the scope began, taking no account of those
+         * made by setting them
+         */
+        void report( benchmark::State &state ) const;
+
+      private:
+        counts begin_;
+        std::uint64_t live_;
+    };
+} // namespace allocations
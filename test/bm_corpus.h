@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/*
+ * Deterministic text resembling production traffic, generated from a fixed seed so that every run of the
+ * benchmarks reads the same bytes. Only the raw output of std::mt19937 is used, as the standard distributions
+ * may differ between library implementations.
+ */
+namespace corpus
+{
+    enum class kind
+    {
+        /*
+         * Web server access log lines
+         */
+        access_log,
+        /*
+         * One JSON object per line
+         */
+        json,
+        /*
+         * Sentences of English-like prose
+         */
+        english
+    };
+
+    inline constexpr std::array<kind, 3> kinds{ kind::access_log, kind::json, kind::english };
+
+    inline const char *name( kind k )
+    {
+        switch( k )
+        {
+        case kind::access_log:
+            return "access_log";
+        case kind::json:
+            return "json";
+        default:
+            return "english";
+        }
+    }
+
+    namespace detail
+    {
+        template <std::size_t N>
+        std::string_view pick( std::mt19937 &random, const std::array<std::string_view, N> &choices )
+        {
+            return choices[random() % N];
+        }
+        /*
+         * Skewed towards the front of choices, as word frequencies are
+         */
+        template <std::size_t N>
+        std::string_view pick_skewed( std::mt19937 &random, const std::array<std::string_view, N> &choices )
+        {
+            const auto first = random() % N;
+
+            return choices[first * ( random() % N ) / N];
+        }
+
+        /*
+         * A number from lower up to but excluding upper. Each is appended by a statement of its own, as the
+         * operands of + may be evaluated in any order
+         */
+        inline void number( std::mt19937 &random, std::string &line, std::uint_fast32_t lower,
+                            std::uint_fast32_t upper )
+        {
+            line += std::to_string( lower + random() % ( upper - lower ) );
+        }
+
+        inline void access_log( std::mt19937 &random, std::string &line )
+        {
+            static constexpr std::array<std::string_view, 12> methods{ "GET", "GET",  "GET", "GET", "GET",    "GET",
+                                                                       "GET", "POST", "POST", "PUT", "DELETE", "HEAD" };
+            static constexpr std::array<std::string_view, 8> paths{
+                "/index.html", "/api/v1/users", "/api/v1/orders", "/static/app.js",
+                "/static/style.css", "/login", "/search?q=regex", "/images/logo.png" };
+            static constexpr std::array<std::string_view, 12> statuses{ "200", "200", "200", "200", "200", "200",
+                                                                        "200", "200", "301", "304", "404", "500" };
+            static constexpr std::array<std::string_view, 4> months{ "Jan", "Apr", "Jul", "Oct" };
+
+            number( random, line, 10, 250 );
+            line += '.';
+            number( random, line, 0, 256 );
+            line += '.';
+            number( random, line, 0, 256 );
+            line += '.';
+            number( random, line, 1, 255 );
+            line += " - - [";
+            number( random, line, 10, 28 );
+            line += '/';
+            line += pick( random, months );
+            line += "/2023:";
+            number( random, line, 10, 24 );
+            line += ':';
+            number( random, line, 10, 60 );
+            line += ':';
+            number( random, line, 10, 60 );
+            line += " +0000] \"";
+            line += pick( random, methods );
+            line += ' ';
+            line += pick( random, paths );
+            line += " HTTP/1.";
+            line += random() % 4 ? '1' : '0';
+            line += "\" ";
+            line += pick( random, statuses );
+            line += ' ';
+            number( random, line, 0, 100000 );
+        }
+
+        inline void json( std::mt19937 &random, std::string &line )
+        {
+            static constexpr std::array<std::string_view, 8> users{ "alice", "bob",   "carol", "dave",
+                                                                    "erin",  "frank", "grace", "heidi" };
+            static constexpr std::array<std::string_view, 6> tags{ "alpha", "beta", "gamma", "delta", "new", "vip" };
+
+            const auto user = pick( random, users );
+
+            line += "{\"id\":";
+            number( random, line, 0, 10000000 );
+            line += ",\"user\":\"";
+            line += user;
+            line += "\",\"email\":\"";
+            line += user;
+            line += "@example.com\",\"score\":";
+            number( random, line, 0, 1000 );
+            line += '.';
+            number( random, line, 0, 10 );
+            line += ",\"tags\":[";
+
+            const auto count = random() % 4;
+
+            for( std::uint_fast32_t i = 0; i < count; ++i )
+            {
+                line += i ? ",\"" : "\"";
+                line += pick( random, tags );
+                line += '"';
+            }
+
+            line += "],\"active\":";
+            line += random() % 3 ? "true}" : "false}";
+        }
+
+        inline void english( std::mt19937 &random, std::string &line )
+        {
+            static constexpr std::array<std::string_view, 48> words{
+                "the",   "of",     "and",   "a",      "to",      "in",    "that",  "his",    "it",     "he",
+                "but",   "as",     "is",    "with",   "was",     "all",   "for",   "this",   "at",     "by",
+                "not",   "from",   "him",   "so",     "whale",   "one",   "you",   "had",    "have",   "there",
+                "or",    "were",   "now",   "which",  "ship",    "sea",   "like",  "upon",   "old",    "into",
+                "boats", "Ahab",   "Ishmael", "captain", "Queequeg", "deck", "Starbuck", "harpoon" };
+            static constexpr std::array<std::string_view, 6> stops{ ".", ".", ".", ";", "!", "?" };
+
+            const auto sentences = 1 + random() % 2;
+
+            for( std::uint_fast32_t s = 0; s < sentences; ++s )
+            {
+                if( s )
+                    line += ' ';
+
+                const auto count = 4 + random() % 10;
+
+                for( std::uint_fast32_t i = 0; i < count; ++i )
+                {
+                    auto word = std::string( pick_skewed( random, words ) );
+
+                    if( i == 0 )
+                        word[0] = static_cast<char>( std::toupper( static_cast<unsigned char>( word[0] ) ) );
+                    else
+                        line += random() % 12 ? " " : ", ";
+
+                    line += word;
+                }
+
+                line += pick( random, stops );
+            }
+        }
+    } // namespace detail
+    /*
+     * Whole lines of kind, each ending with a newline, making up at least size bytes
+     */
+    inline std::string generate( kind k, std::size_t size )
+    {
+        std::mt19937 random( 20230908 + static_cast<unsigned>( k ) );
+        std::string text, line;
+
+        text.reserve( size + 256 );
+
+        while( text.size() < size )
+        {
+            line.clear();
+
+            switch( k )
+            {
+            case kind::access_log:
+                detail::access_log( random, line );
+                break;
+            case kind::json:
+                detail::json( random, line );
+                break;
+            default:
+                detail::english( random, line );
+                break;
+            }
+
+            text += line;
+            text += '\n';
+        }
+
+        return text;
+    }
+    /*
+     * As generate, but made once per process however many benchmarks read it
+     */
+    inline const std::string &cached( kind k, std::size_t size )
+    {
+        static std::map<std::pair<kind, std::size_t>, std::string> corpora;
+
+        auto existing = corpora.find( { k, size } );
+
+        if( existing == std::end( corpora ) )
+            existing = corpora.emplace( std::make_pair( k, size ), generate( k, size ) ).first;
+
+        return existing->second;
+    }
+} // namespace corpus
@@ -1,4 +1,5 @@
 #include "benchmark/benchmark.h"
+#include "bm_allocations.h"
 #include "regex/memory/pool_allocator.h"
 #include "regex/utilities/compile.h"
 #include <iostream>
@@ -13,6 +14,8 @@ static void benchmark_ast( benchmark::State &state )
         ss << "a";
     std::string expression = ss.str();
 
+    allocations::scope counting;
+
     for( auto _ : state ) // iterate iterations
     {
         // only code in here is benchmarked
@@ -21,6 +24,7 @@ static void benchmark_ast( benchmark::State &state )
     }
 
     // loop exits when noise is sufficiently low
+    counting.report( state );
 }
 
 static void benchmark_ast_block_allocator( benchmark::State &state )
@@ -33,6 +37,8 @@ static void benchmark_ast_block_allocator( benchmark::State &state )
         ss << "a";
     std::string expression = ss.str();
 
+    allocations::scope counting;
+
     for( auto _ : state ) // iterate iterations
     {
         // only code in here is benchmarked
@@ -41,6 +47,7 @@ static void benchmark_ast_block_allocator( benchmark::State &state )
     }
 
     // loop exits when noise is sufficiently low
+    counting.report( state );
 }
 
 static void benchmark_compile_nfa_from_ast( benchmark::State &state )
@@ -54,6 +61,8 @@ static void benchmark_compile_nfa_from_ast( benchmark::State &state )
     regex::language::ast<pool_allocator<regex::language::token>> expression =
         regex::language::parse<pool_allocator<regex::language::token>>( ss.str() );
 
+    allocations::scope counting;
+
     for( auto _ : state ) // iterate iterations
     {
         // only code in here is benchmarked
@@ -62,6 +71,7 @@ static void benchmark_compile_nfa_from_ast( benchmark::State &state )
     }
 
     // loop exits when noise is sufficiently low
+    counting.report( state );
 }
 
 static void benchmark_compile_dfa_from_ast( benchmark::State &state )
@@ -74,6 +84,8 @@ static void benchmark_compile_dfa_from_ast( benchmark::State &state )
         ss << "a";
     std::unique_ptr<regex::nfa> expression = regex::compile_nfa( ss.str() );
 
+    allocations::scope counting;
+
     for( auto _ : state ) // iterate iterations
     {
         // only code in here is benchmarked
@@ -82,6 +94,7 @@ static void benchmark_compile_dfa_from_ast( benchmark::State &state )
     }
 
     // loop exits when noise is sufficiently low
+    counting.report( state );
 }
 
 static void benchmark_compile_nfa_from_string( benchmark::State &state )
@@ -94,6 +107,8 @@ static void benchmark_compile_nfa_from_string( benchmark::State &state )
         ss << "a";
     std::string expression = ss.str();
 
+    allocations::scope counting;
+
     for( auto _ : state ) // iterate iterations
     {
         // only code in here is benchmarked
@@ -102,6 +117,7 @@ static void benchmark_compile_nfa_from_string( benchmark::State &state )
     }
 
     // loop exits when noise is sufficiently low
+    counting.report( state );
 }
 
 static void benchmark_compile_dfa_from_string( benchmark::State &state )
@@ -113,7 +129,9 @@ static void benchmark_compile_dfa_from_string( benchmark::State &state )
     for( std::int64_t i = 0; i < n; i++ )
         ss << "a";
     std::string expression = ss.str();
-    
+
+    allocations::scope counting;
+
     for( auto _ : state ) // iterate iterations
     {
         // only code in here is benchmarked
@@ -122,6 +140,7 @@ static void benchmark_compile_dfa_from_string( benchmark::State &state )
     }
 
     // loop exits when noise is sufficiently low
+    counting.report( state );
 }
 
 static void benchmark_execute_nfa( benchmark::State &state )
@@ -135,6 +154,8 @@ static void benchmark_execute_nfa( benchmark::State &state )
     std::unique_ptr<regex::nfa> expression = regex::compile_nfa( ss.str() );
     std::string input( n, 'a' );
 
+    allocations::scope counting;
+
     for( auto _ : state ) // iterate iterations
     {
         // only code in here is benchmarked
@@ -143,6 +164,8 @@ static void benchmark_execute_nfa( benchmark::State &state )
     }
 
     // loop exits when noise is sufficiently low
+    counting.report( state );
+    state.SetBytesProcessed( static_cast<std::int64_t>( state.iterations() * input.size() ) );
 }
 
 static void benchmark_execute_dfa( benchmark::State &state )
@@ -156,6 +179,8 @@ static void benchmark_execute_dfa( benchmark::State &state )
     std::unique_ptr<regex::dfa> expression = regex::compile_dfa( ss.str() );
     std::string input( n, 'a' );
 
+    allocations::scope counting;
+
     for( auto _ : state ) // iterate iterations
     {
         // only code in here is benchmarked
@@ -164,6 +189,8 @@ static void benchmark_execute_dfa( benchmark::State &state )
     }
 
     // loop exits when noise is sufficiently low
+    counting.report( state );
+    state.SetBytesProcessed( static_cast<std::int64_t>( state.iterations() * input.size() ) );
 }
 
 BENCHMARK( benchmark_ast )->Arg( 1 << 0 );
@@ -232,10 +259,10 @@ BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 1 );
 BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 2 );
 BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 3 );
 BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 4 );
-//BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 5 );
-//BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 6 );
-//BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 7 );
-//BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 8 );
+BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 5 );
+BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 6 );
+BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 7 );
+BENCHMARK( benchmark_execute_nfa )->Arg( 1 << 8 );
 
 BENCHMARK( benchmark_execute_dfa )->Arg( 1 << 0 );
 BENCHMARK( benchmark_execute_dfa )->Arg( 1 << 1 );
@@ -0,0 +1,193 @@
+#include "benchmark/benchmark.h"
+#include "bm_allocations.h"
+#include "bm_corpus.h"
+#include "regex/automata/pattern_set.h"
+#include "regex/utilities/compile.h"
+
+#include <memory>
+#include <random>
+#include <string>
+
+/*
+ * Worst cases of each engine, tracked so that a regression in worst case latency shows up here first:
+ *
+ *      (a|b)*a(a|b){k}   the deterministic automaton has 2^(k+1) states
+ *      (a*)*b, (a+)+b    nested quantifiers, exponential for a backtracking matcher, on runs of a without b
+ *      w1|w2|...|wn      long alternations of words
+ *
+ * Subset construction reports the states and bytes of the automaton it built alongside its time.
+ */
+namespace
+{
+    std::string exponential( std::int64_t k )
+    {
+        return "(a|b)*a(a|b){" + std::to_string( k ) + "}";
+    }
+    /*
+     * Random a and b, reaching every state of the exponential automata in turn
+     */
+    std::string adversarial( std::size_t size )
+    {
+        std::mt19937 random( 42 );
+        std::string input( size, 'a' );
+
+        for( auto &character : input )
+            character = random() % 2 ? 'a' : 'b';
+
+        return input;
+    }
+
+    std::string alternation( std::int64_t words )
+    {
+        std::mt19937 random( 7 );
+        std::string expression;
+
+        for( std::int64_t i = 0; i < words; ++i )
+        {
+            if( i )
+                expression += '|';
+
+            const auto length = 3 + random() % 6;
+
+            for( std::uint_fast32_t j = 0; j < length; ++j )
+                expression += static_cast<char>( 'a' + random() % 26 );
+        }
+
+        return expression;
+    }
+
+    void report( benchmark::State &state, const regex::dfa &automaton )
+    {
+        state.counters["states"] = static_cast<double>( automaton.size() );
+        state.counters["bytes"] = static_cast<double>( automaton.bytes() );
+    }
+} // namespace
+
+static void benchmark_exponential_to_dfa( benchmark::State &state )
+{
+    const auto expression = regex::compile_nfa( exponential( state.range( 0 ) ) );
+    std::unique_ptr<regex::dfa> automaton;
+    allocations::scope counting;
+
+    for( auto _ : state )
+    {
+        automaton = expression->to_dfa();
+        benchmark::DoNotOptimize( automaton.get() );
+    }
+
+    counting.report( state );
+    report( state, *automaton );
+}
+
+static void execute( benchmark::State &state, regex::fa &automaton, const std::string &input )
+{
+    allocations::scope counting;
+
+    for( auto _ : state )
+    {
+        benchmark::DoNotOptimize( automaton.execute( input ) );
+        benchmark::ClobberMemory();
+    }
+
+    counting.report( state );
+    state.SetBytesProcessed( static_cast<std::int64_t>( state.iterations() * input.size() ) );
+}
+
+static void benchmark_exponential_execute_nfa( benchmark::State &state )
+{
+    const auto automaton = regex::compile( exponential( state.range( 0 ) ), regex::compile_flag::nfa );
+
+    execute( state, *automaton, adversarial( 1 << 16 ) );
+}
+
+static void benchmark_exponential_execute_dfa( benchmark::State &state )
+{
+    const auto automaton = regex::compile_dfa( exponential( state.range( 0 ) ) );
+
+    execute( state, *automaton, adversarial( 1 << 16 ) );
+    report( state, *automaton );
+}
+/*
+ * From k = 13 on the 2^(k+1) states no longer fit in the cache of the lazy automaton, which keeps starting over
+ */
+static void benchmark_exponential_execute_lazy( benchmark::State &state )
+{
+    const auto automaton = regex::compile_patterns( { exponential( state.range( 0 ) ) } );
+
+    execute( state, *automaton, adversarial( 1 << 16 ) );
+}
+
+static void benchmark_nested_execute_nfa( benchmark::State &state )
+{
+    const auto automaton = regex::compile( "(a*)*b", regex::compile_flag::nfa );
+
+    execute( state, *automaton, std::string( static_cast<std::size_t>( state.range( 0 ) ), 'a' ) );
+}
+
+static void benchmark_nested_execute_dfa( benchmark::State &state )
+{
+    const auto automaton = regex::compile( "(a+)+b", regex::compile_flag::dfa );
+
+    execute( state, *automaton, std::string( static_cast<std::size_t>( state.range( 0 ) ), 'a' ) );
+}
+
+static void benchmark_nested_captures( benchmark::State &state )
+{
+    const auto automaton = regex::compile_captures( "((a*)*|b)+c" );
+    const std::string input( static_cast<std::size_t>( state.range( 0 ) ), 'a' );
+    allocations::scope counting;
+
+    for( auto _ : state )
+    {
+        benchmark::DoNotOptimize( automaton->capture( input ) );
+        benchmark::ClobberMemory();
+    }
+
+    counting.report( state );
+    state.SetBytesProcessed( static_cast<std::int64_t>( state.iterations() * input.size() ) );
+}
+
+static void benchmark_alternation_to_dfa( benchmark::State &state )
+{
+    const auto expression = regex::compile_nfa( ".*(" + alternation( state.range( 0 ) ) + ").*" );
+    std::unique_ptr<regex::dfa> automaton;
+    allocations::scope counting;
+
+    for( auto _ : state )
+    {
+        automaton = expression->to_dfa();
+        benchmark::DoNotOptimize( automaton.get() );
+    }
+
+    counting.report( state );
+    report( state, *automaton );
+}
+
+static void benchmark_alternation_execute_nfa( benchmark::State &state )
+{
+    const auto automaton =
+        regex::compile( ".*(" + alternation( state.range( 0 ) ) + ").*", regex::compile_flag::nfa );
+
+    execute( state, *automaton, corpus::cached( corpus::kind::english, 1 << 12 ) );
+}
+
+static void benchmark_alternation_execute_dfa( benchmark::State &state )
+{
+    const auto automaton = regex::compile_dfa( ".*(" + alternation( state.range( 0 ) ) + ").*" );
+
+    execute( state, *automaton, corpus::cached( corpus::kind::english, 1 << 12 ) );
+    report( state, *automaton );
+}
+
+BENCHMARK( benchmark_exponential_to_dfa )->DenseRange( 2, 14, 2 )->Unit( benchmark::kMicrosecond );
+BENCHMARK( benchmark_exponential_execute_nfa )->DenseRange( 2, 14, 4 )->Unit( benchmark::kMicrosecond );
+BENCHMARK( benchmark_exponential_execute_dfa )->DenseRange( 2, 14, 4 )->Unit( benchmark::kMicrosecond );
+BENCHMARK( benchmark_exponential_execute_lazy )->DenseRange( 2, 18, 4 )->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_nested_execute_nfa )->RangeMultiplier( 16 )->Range( 1 << 4, 1 << 16 );
+BENCHMARK( benchmark_nested_execute_dfa )->RangeMultiplier( 16 )->Range( 1 << 4, 1 << 16 );
+BENCHMARK( benchmark_nested_captures )->RangeMultiplier( 16 )->Range( 1 << 4, 1 << 12 );
+
+BENCHMARK( benchmark_alternation_to_dfa )->RangeMultiplier( 4 )->Range( 16, 256 )->Unit( benchmark::kMillisecond );
+BENCHMARK( benchmark_alternation_execute_nfa )->RangeMultiplier( 4 )->Range( 16, 256 );
+BENCHMARK( benchmark_alternation_execute_dfa )->RangeMultiplier( 4 )->Range( 16, 256 );
@@ -0,0 +1,260 @@
+#include "benchmark/benchmark.h"
+#include "bm_allocations.h"
+#include "bm_corpus.h"
+#include "regex/automata/pattern_set.h"
+#include "regex/utilities/compile.h"
+
+#include <cstring>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Throughput of each engine matching every line of a generated corpus, as the regex tool does, reported in
+ * bytes per second. Each pattern is run both as a full match of the line and as a search for it anywhere in
+ * the line, i.e. wrapped in .*( ).* as this library has no unanchored mode. Validators describe a whole line
+ * so are only run as full matches.
+ *
+ * The same patterns are run through std::regex as the engine std, by std::regex_match and std::regex_search of
+ * the pattern as written, and the cost of compiling each pattern for each engine is measured alongside.
+ *
+ *      benchmark-regex --benchmark_filter='throughput/access_log/.*\/dfa/search/1048576'
+ *      benchmark-regex --benchmark_filter='(compile|throughput)/json/class/(dfa|std)/'
+ */
+namespace
+{
+    struct family
+    {
+        const char *name;
+        const char *pattern;
+        bool validator = false;
+    };
+
+    enum class engine
+    {
+        nfa,
+        dfa,
+        lazy,
+        std
+    };
+
+    const std::vector<std::pair<corpus::kind, std::vector<family>>> families{
+        { corpus::kind::access_log,
+          {
+              { "literal", "POST" },
+              { "alternation", "PUT|DELETE|HEAD" },
+              { "class", "[0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+" },
+              { "sandwich", "GET.*\" 404 " },
+              { "validator",
+                "[0-9]+(\\.[0-9]+){3} - - \\[[0-9]{2}/[A-Z][a-z]{2}/[0-9]{4}(:[0-9]{2}){3} \\+0000\\] "
+                "\"[A-Z]+ [^ \"]+ HTTP/1\\.[01]\" [0-9]{3} [0-9]+",
+                true },
+          } },
+        { corpus::kind::json,
+          {
+              { "literal", "\"active\":false" },
+              { "alternation", "\"(alpha|beta|gamma|delta)\"" },
+              { "class", "\"score\":[0-9]+\\.[0-9]" },
+              { "sandwich", "\"user\":\"a.*\"active\":true" },
+              { "validator",
+                "\\{\"id\":[0-9]+,\"user\":\"[a-z]+\",\"email\":\"[a-z]+@example\\.com\",\"score\":[0-9]+\\.[0-9],"
+                "\"tags\":\\[(\"[a-z]+\"(,\"[a-z]+\")*)?\\],\"active\":(true|false)\\}",
+                true },
+          } },
+        { corpus::kind::english,
+          {
+              { "literal", "whale" },
+              { "alternation", "Ahab|Ishmael|Queequeg|Starbuck" },
+              { "class", "[A-Z][a-z]+ [A-Z][a-z]+" },
+              { "sandwich", "The.*sea" },
+              { "validator", "([A-Za-z]+,? )*[A-Za-z]+[.;!?]( [A-Za-z]+(,? [A-Za-z]+)*[.;!?])*", true },
+          } },
+    };
+
+    const char *name( engine e )
+    {
+        switch( e )
+        {
+        case engine::nfa:
+            return "nfa";
+        case engine::dfa:
+            return "dfa";
+        case engine::lazy:
+            return "lazy";
+        default:
+            return "std";
+        }
+    }
+
+    std::shared_ptr<regex::fa> compile( engine e, const std::string &pattern )
+    {
+        switch( e )
+        {
+        case engine::nfa:
+            return regex::compile( pattern, regex::compile_flag::nfa );
+        case engine::dfa:
+            return regex::compile( pattern, regex::compile_flag::dfa );
+        default:
+            return regex::compile_patterns( { pattern } );
+        }
+    }
+    /*
+     * As the regex tool compiles std::regex, given that no groups are read
+     */
+    std::regex compile_std( const std::string &pattern )
+    {
+        return std::regex( pattern, std::regex::ECMAScript | std::regex::nosubs | std::regex::optimize );
+    }
+    /*
+     * Count the lines of text matched by match
+     */
+    template <typename Match>
+    std::size_t match_lines( std::string_view text, Match match )
+    {
+        std::size_t matches = 0;
+
+        while( !text.empty() )
+        {
+            const void *newline = std::memchr( text.data(), '\n', text.size() );
+            const auto length =
+                newline ? static_cast<std::size_t>( static_cast<const char *>( newline ) - text.data() ) : text.size();
+
+            if( match( text.substr( 0, length ) ) )
+                ++matches;
+
+            text.remove_prefix( newline ? length + 1 : length );
+        }
+
+        return matches;
+    }
+
+    template <typename Match>
+    void throughput( benchmark::State &state, const std::string &text, Match match )
+    {
+        std::size_t matches = 0;
+        allocations::scope counting;
+
+        for( auto _ : state )
+        {
+            matches = match_lines( text, match );
+            benchmark::DoNotOptimize( matches );
+        }
+
+        counting.report( state );
+        state.SetBytesProcessed( static_cast<std::int64_t>( state.iterations() * text.size() ) );
+        state.counters["matches"] = static_cast<double>( matches );
+    }
+    /*
+     * Match every line of the corpus in full, or for std::regex search each line for pattern when search is set
+     */
+    void throughput( benchmark::State &state, corpus::kind k, engine e, const std::string &pattern, bool search )
+    {
+        const auto &text = corpus::cached( k, static_cast<std::size_t>( state.range( 0 ) ) );
+
+        if( e == engine::std )
+        {
+            const auto expression = compile_std( pattern );
+
+            if( search )
+                throughput( state, text, [&expression]( std::string_view line ) {
+                    return std::regex_search( std::cbegin( line ), std::cend( line ), expression );
+                } );
+            else
+                throughput( state, text, [&expression]( std::string_view line ) {
+                    return std::regex_match( std::cbegin( line ), std::cend( line ), expression );
+                } );
+
+            return;
+        }
+
+        const auto automaton = compile( e, pattern );
+        const auto cursor = automaton->make_cursor();
+
+        throughput( state, text, [&cursor]( std::string_view line ) {
+            cursor->reset();
+            return cursor->advance( line ) && cursor->accepted();
+        } );
+    }
+    /*
+     * Compile pattern for the engine, reporting what the compile allocated and the bytes of the automaton where
+     * the engine tells them
+     */
+    void compile_time( benchmark::State &state, engine e, const std::string &pattern )
+    {
+        regex::compile_stats stats;
+        allocations::scope counting;
+
+        for( auto _ : state )
+        {
+            switch( e )
+            {
+            case engine::nfa:
+                benchmark::DoNotOptimize( regex::compile( pattern, regex::compile_flag::nfa, {}, stats ) );
+                break;
+            case engine::dfa:
+                benchmark::DoNotOptimize( regex::compile( pattern, regex::compile_flag::dfa, {}, stats ) );
+                break;
+            case engine::lazy:
+                benchmark::DoNotOptimize( regex::compile_patterns( { pattern } ) );
+                break;
+            default:
+                benchmark::DoNotOptimize( compile_std( pattern ) );
+                break;
+            }
+        }
+
+        counting.report( state );
+
+        if( e == engine::nfa )
+            state.counters["bytes"] = static_cast<double>( stats.nfa_bytes );
+        else if( e == engine::dfa )
+            state.counters["bytes"] = static_cast<double>( stats.dfa_bytes );
+    }
+
+    const bool registered = []() {
+        for( const auto &[k, patterns] : families )
+        {
+            for( const auto &f : patterns )
+            {
+                for( const auto e : { engine::nfa, engine::dfa, engine::lazy, engine::std } )
+                {
+                    for( const bool search : { false, true } )
+                    {
+                        if( search && f.validator )
+                            continue;
+                        /*
+                         * std::regex searches unanchored by itself
+                         */
+                        const std::string pattern =
+                            search && e != engine::std ? ".*(" + std::string( f.pattern ) + ").*" : f.pattern;
+                        const std::string suffix =
+                            std::string( corpus::name( k ) ) + '/' + f.name + '/' + name( e ) +
+                            ( search ? "/search" : "/match" );
+
+                        benchmark::RegisterBenchmark( ( "compile/" + suffix ).c_str(),
+                                                      [e, pattern]( benchmark::State &state ) {
+                                                          compile_time( state, e, pattern );
+                                                      } )
+                            ->Unit( benchmark::kMicrosecond );
+
+                        const auto benchmark = benchmark::RegisterBenchmark(
+                            ( "throughput/" + suffix ).c_str(), [k, e, pattern, search]( benchmark::State &state ) {
+                                throughput( state, k, e, pattern, search );
+                            } );
+
+                        benchmark->Arg( 1 << 10 )->Arg( 1 << 16 )->Arg( 1 << 20 )->Unit( benchmark::kMicrosecond );
+                        /*
+                         * std::regex reads a few MB/s at best, too slow to read the largest corpus repeatedly
+                         */
+                        if( e != engine::std )
+                            benchmark->Arg( 100 << 20 );
+                    }
+                }
+            }
+        }
+
+        return true;
+    }();
+} // namespace
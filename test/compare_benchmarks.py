@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+"""Compare a Google Benchmark JSON result of benchmark-regex against a baseline.
+
+Each benchmark is matched with the baseline run of the same name, and every metric both runs report is compared
+by the median of its repetitions:
+
+    cpu_time, real_time                          lower is better
+    bytes_per_second, items_per_second           higher is better
+    allocations, allocated_bytes, peak_bytes     lower is better
+
+A metric regresses when its median moves the wrong way by more than the threshold of the benchmark and, if both
+sides have at least four repetitions, a Mann-Whitney U test finds the samples differ at the chosen significance.
+Allocation counts are deterministic, so they regress on the threshold alone. Being averaged over the iterations,
+those made once, on the first iteration, shift with the number of iterations run, so allocations only regress by at
+least one more per iteration, and allocated_bytes only where allocations are made on every iteration.
+
+Thresholds are read from a file of lines "<regular expression> <percent>", the first expression found in the
+name of a benchmark giving its threshold, e.g.
+
+    throughput/.*/100       15
+    benchmark_execute_      5
+
+    benchmark-regex --benchmark_repetitions=5 --benchmark_out=current.json --benchmark_out_format=json
+    compare_benchmarks.py regex-benchmark.json current.json --thresholds benchmark-thresholds.txt
+
+The exit status is 0 when nothing regressed, 1 when something did and 2 when the input could not be read.
+"""
+
+import argparse
+import collections
+import itertools
+import json
+import math
+import re
+import statistics
+import sys
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+# Metric and whether a larger value is worse
+METRICS = {
+    "cpu_time": True,
+    "real_time": True,
+    "bytes_per_second": False,
+    "items_per_second": False,
+    "allocations": True,
+    "allocated_bytes": True,
+    "peak_bytes": True,
+}
+
+DETERMINISTIC = {"allocations", "allocated_bytes", "peak_bytes"}
+
+# Fewer repetitions than this on either side can never differ significantly, so leave it to the threshold alone
+REPETITIONS = 4
+
+# Samples up to this size together are tested exactly
+EXACT = 16
+
+
+def load(path):
+    """Samples of each metric of each benchmark, keyed by run name, in the order they were run."""
+    with open(path) as f:
+        document = json.load(f)
+
+    runs = {}
+
+    for b in document["benchmarks"]:
+        if b.get("run_type", "iteration") != "iteration" or "error_occurred" in b:
+            continue
+
+        samples = runs.setdefault(b.get("run_name", b["name"]), {})
+        scale = TIME_UNITS[b.get("time_unit", "ns")]
+
+        for metric in METRICS:
+            if metric in b:
+                value = b[metric] * scale if metric.endswith("_time") else b[metric]
+                samples.setdefault(metric, []).append(float(value))
+
+    return runs
+
+
+def load_thresholds(path):
+    thresholds = []
+
+    if path:
+        with open(path) as f:
+            for line in f:
+                line = line.split("#", 1)[0].strip()
+
+                if line:
+                    expression, percent = line.rsplit(None, 1)
+                    thresholds.append((re.compile(expression), float(percent)))
+
+    return thresholds
+
+
+def threshold(thresholds, name, default):
+    for expression, percent in thresholds:
+        if expression.search(name):
+            return percent
+
+    return default
+
+
+def ranks(values):
+    """Rank of each value from 1, tied values sharing the mean of their ranks."""
+    order = sorted(range(len(values)), key=values.__getitem__)
+    result = [0.0] * len(values)
+    i = 0
+
+    while i < len(order):
+        j = i
+
+        while j + 1 < len(order) and values[order[j + 1]] == values[order[i]]:
+            j += 1
+
+        for k in range(i, j + 1):
+            result[order[k]] = (i + j) / 2 + 1
+
+        i = j + 1
+
+    return result
+
+
+def mann_whitney(a, b):
+    """Two sided p value of the Mann-Whitney U test, exact for small samples and by the normal approximation
+    otherwise."""
+    n1, n2 = len(a), len(b)
+    r = ranks(a + b)
+    mean = n1 * n2 / 2
+    u = sum(r[:n1]) - n1 * (n1 + 1) / 2
+
+    if n1 + n2 <= EXACT:
+        # Every way of drawing the ranks of a, as likely as each other if the samples do not differ
+        extreme = total = 0
+
+        for drawn in itertools.combinations(r, n1):
+            total += 1
+            extreme += abs(sum(drawn) - n1 * (n1 + 1) / 2 - mean) >= abs(u - mean) - 1e-9
+
+        return extreme / total
+
+    ties = sum(c ** 3 - c for c in collections.Counter(r).values())
+    n = n1 + n2
+    variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)))
+
+    if variance <= 0:
+        return 1.0
+
+    z = max(abs(u - mean) - 0.5, 0.0) / math.sqrt(variance)
+
+    return math.erfc(z / math.sqrt(2))
+
+
+def compare(baseline, current, thresholds, default, alpha):
+    """Rows of (name, metric, baseline, current, change, p, regressed) and the names of unmatched benchmarks."""
+    rows = []
+
+    for name, metrics in current.items():
+        if name not in baseline:
+            continue
+
+        limit = threshold(thresholds, name, default)
+
+        for metric, samples in metrics.items():
+            before = baseline[name].get(metric)
+
+            if not before:
+                continue
+
+            old, new = statistics.median(before), statistics.median(samples)
+            change = (new - old) / old * 100 if old else (0.0 if new == old else math.inf)
+            worse = change if METRICS[metric] else -change
+            p = None
+
+            if metric not in DETERMINISTIC and min(len(before), len(samples)) >= REPETITIONS:
+                p = mann_whitney(before, samples)
+
+            regressed = worse > limit and (p is None or p < alpha)
+
+            if metric == "allocations":
+                regressed = regressed and new - old >= 1
+            elif metric == "allocated_bytes":
+                regressed = regressed and statistics.median(metrics.get("allocations", [0.0])) >= 1
+
+            rows.append((name, metric, old, new, change, p, regressed))
+
+    added = sorted(set(current) - set(baseline))
+    removed = sorted(set(baseline) - set(current))
+
+    return rows, added, removed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n", 1)[0])
+    parser.add_argument("baseline", help="stored Google Benchmark JSON result")
+    parser.add_argument("current", help="Google Benchmark JSON result to check")
+    parser.add_argument("--thresholds", help="file of per benchmark thresholds")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percent change allowed where no threshold matches (default 10)")
+    parser.add_argument("--alpha", type=float, default=0.05, help="significance of the U test (default 0.05)")
+    parser.add_argument("--all", action="store_true",
+                        help="write every comparison and every baseline benchmark not run, not only regressions")
+    arguments = parser.parse_args()
+
+    try:
+        baseline = load(arguments.baseline)
+        current = load(arguments.current)
+        thresholds = load_thresholds(arguments.thresholds)
+    except (OSError, ValueError, KeyError) as e:
+        print(f"compare_benchmarks: {e}", file=sys.stderr)
+        return 2
+
+    rows, added, removed = compare(baseline, current, thresholds, arguments.threshold, arguments.alpha)
+    regressions = [row for row in rows if row[6]]
+
+    for name, metric, old, new, change, p, regressed in rows if arguments.all else regressions:
+        significance = "" if p is None else f"  p={p:.3f}"
+        print(f"{'REGRESSED' if regressed else 'ok':<9}  {name}  {metric}  {old:.6g} -> {new:.6g}  "
+              f"{change:+.1f}%{significance}")
+
+    for name in added:
+        print(f"{'new':<9}  {name}")
+
+    for name in removed if arguments.all else []:
+        print(f"{'missing':<9}  {name}")
+
+    print(f"{len(regressions)} regressions in {len(rows)} comparisons of {len(current)} benchmarks")
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
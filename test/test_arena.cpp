@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "regex/automata/nfa.h"
+#include "regex/memory/arena.h"
+#include "regex/memory/pool_allocator.h"
+
+TEST( arena, grows )
+{
+    regex::memory::arena arena( 64 );
+    std::pmr::vector<std::uint64_t> values( &arena );
+
+    for( std::uint64_t i = 0; i < 10000; ++i )
+        values.push_back( i );
+
+    EXPECT_EQ( values.back(), 9999u );
+    EXPECT_GE( arena.allocated(), 10000 * sizeof( std::uint64_t ) );
+    EXPECT_GE( arena.reserved(), arena.allocated() );
+}
+
+TEST( arena, alignment )
+{
+    regex::memory::arena arena;
+
+    EXPECT_NE( arena.allocate( 1, 1 ), nullptr );
+    void *p = arena.allocate( 64, 64 );
+
+    EXPECT_EQ( reinterpret_cast<std::uintptr_t>( p ) % 64, 0u );
+}
+
+TEST( arena, release )
+{
+    regex::memory::arena arena;
+
+    EXPECT_NE( arena.allocate( 100000, 8 ), nullptr );
+    arena.release();
+
+    EXPECT_EQ( arena.allocated(), 0u );
+    EXPECT_EQ( arena.reserved(), 0u );
+    EXPECT_NE( arena.allocate( 8, 8 ), nullptr );
+}
+
+TEST( arena, pool_allocator_grows )
+{
+    pool_allocator<std::uint64_t> allocator( 1 );
+
+    EXPECT_NE( allocator.allocate( 1 ), nullptr );
+    EXPECT_NE( allocator.allocate( 1000 ), nullptr );
+}
+
+TEST( arena, nfa )
+{
+    std::unique_ptr<regex::nfa> copy;
+
+    {
+        regex::memory::arena arena;
+        auto expression = regex::nfa::from_concatenation( regex::nfa::from_character( 'a', &arena ),
+                                                          regex::nfa::from_kleene( regex::nfa::from_any( &arena ) ) );
+        copy = std::make_unique<regex::nfa>( *expression );
+    }
+
+    EXPECT_TRUE( copy->execute( "abc" ) );
+    EXPECT_FALSE( copy->execute( "bc" ) );
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <array>
+#include <sstream>
 
 #include "regex/utilities/cmdline.h"
 
@@ -57,3 +58,102 @@ TEST( cmdline, too_many_positionals )
 
     EXPECT_THROW( args.parse( 5, cmdline ), regex::cmd::exception );
 }
+
+TEST( cmdline, flags )
+{
+    regex::cmd::cmdline args("description");
+
+    args.add_flag( "-v", "verbose", "Verbose logging" );
+    args.add_flag( "-o", "optimise", "Optimise" );
+    args.add_positional( "regex", regex::cmd::cmdline::type::string, "Regular expression" );
+    args.add_positional( "target", regex::cmd::cmdline::type::string, "Target to match" );
+
+    const char* cmdline[]{ "regex", "-v", "a+b*cc", "-" };
+
+    args.parse( 4, cmdline );
+
+    EXPECT_TRUE( args.get_flag( "verbose" ) );
+    EXPECT_FALSE( args.get_flag( "optimise" ) );
+    EXPECT_EQ( args.get_argument<std::string>( "target" ), "-" );
+}
+
+TEST( cmdline, defaults )
+{
+    regex::cmd::cmdline args("description");
+
+    args.add_optional( "-t", "type", regex::cmd::cmdline::type::string, "nfa", "Type of finite automata" );
+    args.add_optional( "-j", "jobs", regex::cmd::cmdline::type::integral, 1, "Threads" );
+    args.add_positional( "regex", regex::cmd::cmdline::type::string, "Regular expression" );
+
+    const char* cmdline[]{ "regex", "-j", "8", "a+b*cc" };
+
+    args.parse( 4, cmdline );
+
+    EXPECT_EQ( args.get_argument<std::string>( "type" ), "nfa" );
+    EXPECT_EQ( args.get_argument<int>( "jobs" ), 8 );
+
+    const char* invalid[]{ "regex", "-j", "eight", "a+b*cc" };
+
+    EXPECT_THROW( args.parse( 4, invalid ), regex::cmd::exception );
+}
+
+TEST( cmdline, waived )
+{
+    regex::cmd::cmdline args("description");
+
+    args.add_optional( "-f", "patterns", regex::cmd::cmdline::type::string, "", "File of regular expressions" );
+    args.add_positional( "regex", regex::cmd::cmdline::type::string, "Regular expression" );
+    args.add_variadic( "targets", "Targets to match" );
+    args.waive( "regex", "-f" );
+
+    const char* cmdline[]{ "regex", "-f", "patterns.txt" };
+
+    args.parse( 3, cmdline );
+
+    EXPECT_EQ( args.get_argument<std::string>( "patterns" ), "patterns.txt" );
+    EXPECT_EQ( args.get_argument<std::string>( "regex" ), "" );
+    EXPECT_TRUE( args.get_argument<std::vector<std::string>>( "targets" ).empty() );
+
+    regex::cmd::cmdline unwaived("description");
+
+    unwaived.add_optional( "-f", "patterns", regex::cmd::cmdline::type::string, "", "File of regular expressions" );
+    unwaived.add_positional( "regex", regex::cmd::cmdline::type::string, "Regular expression" );
+    unwaived.waive( "regex", "-f" );
+
+    const char* missing[]{ "regex" };
+
+    EXPECT_THROW( unwaived.parse( 1, missing ), regex::cmd::exception );
+}
+
+TEST( cmdline, usage_columns )
+{
+    regex::cmd::cmdline args("description");
+
+    args.add_flag( "-l", "files-with-matches", "Write the path of each file with a matching line" );
+    args.add_flag( "-q", "quiet", "Write nothing" );
+
+    std::ostringstream usage;
+    usage << args;
+
+    EXPECT_NE( usage.str().find( "-l        files-with-matches Write the path" ), std::string::npos );
+    EXPECT_NE( usage.str().find( "-q        quiet              Write nothing" ), std::string::npos );
+}
+
+TEST( cmdline, options )
+{
+    regex::cmd::cmdline args("description");
+
+    args.add_optional( "-t", "type", regex::cmd::cmdline::type::string, "auto", "Type of finite automata",
+                       { "auto", "nfa", "dfa", "lazy" } );
+    args.add_positional( "regex", regex::cmd::cmdline::type::string, "Regular expression" );
+
+    const char* cmdline[]{ "regex", "-t", "lazy", "a+b*cc" };
+
+    args.parse( 4, cmdline );
+
+    EXPECT_EQ( args.get_argument<std::string>( "type" ), "lazy" );
+
+    const char* invalid[]{ "regex", "-t", "foo", "a+b*cc" };
+
+    EXPECT_THROW( args.parse( 4, invalid ), regex::cmd::exception );
+}
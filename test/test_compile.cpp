@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
 
 #include "regex/utilities/compile.h"
 
@@ -43,6 +45,50 @@ TEST( compile_nfa, one_or_more )
     EXPECT_TRUE( regex::compile( "a+", regex::compile_flag::nfa )->execute( "a" ) );
     EXPECT_FALSE( regex::compile( "a+", regex::compile_flag::nfa )->execute( "b" ) );
     EXPECT_TRUE( regex::compile( "a+", regex::compile_flag::nfa )->execute( "aa" ) );
+    EXPECT_TRUE( regex::compile( "((a+b)+c)+", regex::compile_flag::nfa )->execute( "abaabcabc" ) );
+    EXPECT_FALSE( regex::compile( "((a+b)+c)+", regex::compile_flag::nfa )->execute( "abaabcab" ) );
+}
+
+TEST( compile_nfa, character_class )
+{
+    EXPECT_TRUE( regex::compile( "[a-z0-9_]+", regex::compile_flag::nfa )->execute( "abc_123" ) );
+    EXPECT_FALSE( regex::compile( "[a-z0-9_]+", regex::compile_flag::nfa )->execute( "abc-123" ) );
+    EXPECT_TRUE( regex::compile( "[^a-c]", regex::compile_flag::nfa )->execute( "d" ) );
+    EXPECT_FALSE( regex::compile( "[^a-c]", regex::compile_flag::nfa )->execute( "b" ) );
+    EXPECT_TRUE( regex::compile( "\\d+\\s\\w", regex::compile_flag::nfa )->execute( "42\tx" ) );
+    EXPECT_FALSE( regex::compile( "\\d+\\s\\w", regex::compile_flag::nfa )->execute( "4x\tx" ) );
+    EXPECT_TRUE( regex::compile( "a\\.\\*", regex::compile_flag::nfa )->execute( "a.*" ) );
+    EXPECT_FALSE( regex::compile( "a\\.\\*", regex::compile_flag::nfa )->execute( "ab*" ) );
+    EXPECT_TRUE( regex::compile( ".", regex::compile_flag::nfa )->execute( "\xff" ) );
+}
+
+TEST( compile_nfa, repetition )
+{
+    EXPECT_TRUE( regex::compile( "a{3}", regex::compile_flag::nfa )->execute( "aaa" ) );
+    EXPECT_FALSE( regex::compile( "a{3}", regex::compile_flag::nfa )->execute( "aa" ) );
+    EXPECT_FALSE( regex::compile( "a{3}", regex::compile_flag::nfa )->execute( "aaaa" ) );
+    EXPECT_TRUE( regex::compile( "(ab){1,2}c", regex::compile_flag::nfa )->execute( "ababc" ) );
+    EXPECT_FALSE( regex::compile( "(ab){1,2}c", regex::compile_flag::nfa )->execute( "c" ) );
+    EXPECT_TRUE( regex::compile( "a{2,}", regex::compile_flag::nfa )->execute( "aaaaa" ) );
+    EXPECT_FALSE( regex::compile( "a{2,}", regex::compile_flag::nfa )->execute( "a" ) );
+    EXPECT_TRUE( regex::compile( "x{0}y", regex::compile_flag::nfa )->execute( "y" ) );
+    EXPECT_TRUE( regex::compile( "\\d{1,64}", regex::compile_flag::nfa )->execute( std::string( 64, '7' ) ) );
+    EXPECT_FALSE( regex::compile( "\\d{1,64}", regex::compile_flag::nfa )->execute( std::string( 65, '7' ) ) );
+    EXPECT_TRUE( regex::compile( ".{0,1000}x", regex::compile_flag::nfa )->execute( std::string( 1000, '.' ) + 'x' ) );
+    EXPECT_FALSE( regex::compile( ".{0,1000}x", regex::compile_flag::nfa )->execute( std::string( 1001, '.' ) + 'x' ) );
+}
+
+TEST( compile_nfa, nested_repetition )
+{
+    /*
+     * Each count is within repetition_limit, but the copies multiply
+     */
+    EXPECT_THROW( regex::compile( "(a{1000}){1000}", regex::compile_flag::nfa ), std::runtime_error );
+    EXPECT_THROW( regex::compile( "((a{100}){100}){100}", regex::compile_flag::dfa ), std::runtime_error );
+    EXPECT_THROW( regex::compile( "(a{1000,}){1000,}", regex::compile_flag::nfa ), std::runtime_error );
+    EXPECT_THROW( regex::compile_captures( "((a{100}){100}){100}" ), std::runtime_error );
+    EXPECT_THROW( regex::compile_patterns( { "a", "(a{1000}){1000}" } ), std::runtime_error );
+    EXPECT_TRUE( regex::compile( "(a{10}){100}", regex::compile_flag::nfa )->execute( std::string( 1000, 'a' ) ) );
 }
 
 TEST( compile_nfa, complex )
@@ -92,6 +138,37 @@ TEST( compile_dfa, one_or_more )
     EXPECT_TRUE( regex::compile( "a+", regex::compile_flag::dfa )->execute( "a" ) );
     EXPECT_FALSE( regex::compile( "a+", regex::compile_flag::dfa )->execute( "b" ) );
     EXPECT_TRUE( regex::compile( "a+", regex::compile_flag::dfa )->execute( "aa" ) );
+    EXPECT_TRUE( regex::compile( "((a+b)+c)+", regex::compile_flag::dfa )->execute( "abaabcabc" ) );
+    EXPECT_FALSE( regex::compile( "((a+b)+c)+", regex::compile_flag::dfa )->execute( "abaabcab" ) );
+}
+
+TEST( compile_dfa, character_class )
+{
+    EXPECT_TRUE( regex::compile( "[a-z0-9_]+", regex::compile_flag::dfa )->execute( "abc_123" ) );
+    EXPECT_FALSE( regex::compile( "[a-z0-9_]+", regex::compile_flag::dfa )->execute( "abc-123" ) );
+    EXPECT_TRUE( regex::compile( "[^a-c]", regex::compile_flag::dfa )->execute( "d" ) );
+    EXPECT_FALSE( regex::compile( "[^a-c]", regex::compile_flag::dfa )->execute( "b" ) );
+    EXPECT_TRUE( regex::compile( "\\d+\\s\\w", regex::compile_flag::dfa )->execute( "42\tx" ) );
+    EXPECT_FALSE( regex::compile( "\\d+\\s\\w", regex::compile_flag::dfa )->execute( "4x\tx" ) );
+    EXPECT_TRUE( regex::compile( "a\\.\\*", regex::compile_flag::dfa )->execute( "a.*" ) );
+    EXPECT_FALSE( regex::compile( "a\\.\\*", regex::compile_flag::dfa )->execute( "ab*" ) );
+    EXPECT_TRUE( regex::compile( ".", regex::compile_flag::dfa )->execute( "\xff" ) );
+}
+
+TEST( compile_dfa, repetition )
+{
+    EXPECT_TRUE( regex::compile( "a{3}", regex::compile_flag::dfa )->execute( "aaa" ) );
+    EXPECT_FALSE( regex::compile( "a{3}", regex::compile_flag::dfa )->execute( "aa" ) );
+    EXPECT_FALSE( regex::compile( "a{3}", regex::compile_flag::dfa )->execute( "aaaa" ) );
+    EXPECT_TRUE( regex::compile( "(ab){1,2}c", regex::compile_flag::dfa )->execute( "ababc" ) );
+    EXPECT_FALSE( regex::compile( "(ab){1,2}c", regex::compile_flag::dfa )->execute( "c" ) );
+    EXPECT_TRUE( regex::compile( "a{2,}", regex::compile_flag::dfa )->execute( "aaaaa" ) );
+    EXPECT_FALSE( regex::compile( "a{2,}", regex::compile_flag::dfa )->execute( "a" ) );
+    EXPECT_TRUE( regex::compile( "x{0}y", regex::compile_flag::dfa )->execute( "y" ) );
+    EXPECT_TRUE( regex::compile( "\\d{1,64}", regex::compile_flag::dfa )->execute( std::string( 64, '7' ) ) );
+    EXPECT_FALSE( regex::compile( "\\d{1,64}", regex::compile_flag::dfa )->execute( std::string( 65, '7' ) ) );
+    EXPECT_TRUE( regex::compile( ".{0,1000}x", regex::compile_flag::dfa )->execute( std::string( 1000, '.' ) + 'x' ) );
+    EXPECT_FALSE( regex::compile( ".{0,1000}x", regex::compile_flag::dfa )->execute( std::string( 1001, '.' ) + 'x' ) );
 }
 
 TEST( compile_dfa, complex )
@@ -100,3 +177,194 @@ TEST( compile_dfa, complex )
     EXPECT_TRUE( regex::compile( "a?.*(c*|d+)b*e", regex::compile_flag::dfa )->execute( "adbbe" ) );
     EXPECT_FALSE( regex::compile( "a?.*(c+|d+)b*e", regex::compile_flag::dfa )->execute( "afffbbe" ) );
 }
+
+TEST( compile, case_insensitive )
+{
+    for( const auto flag : { regex::compile_flag::nfa, regex::compile_flag::dfa } )
+    {
+        const auto automaton =
+            regex::compile( "error: [a-z]+ failed", flag, regex::language::syntax_flag::case_insensitive );
+
+        EXPECT_TRUE( automaton->execute( "ERROR: Disk failed" ) );
+        EXPECT_TRUE( automaton->execute( "Error: disk FAILED" ) );
+        EXPECT_FALSE( automaton->execute( "ERROR: 42 failed" ) );
+        EXPECT_FALSE( regex::compile( "error", flag )->execute( "ERROR" ) );
+
+        const auto greek = regex::compile( "\xce\xbb\xcf\x8c[\xce\xb1-\xcf\x89]+", flag,
+                                           regex::language::syntax_flag::utf8 |
+                                               regex::language::syntax_flag::case_insensitive );
+
+        EXPECT_TRUE( greek->execute( "\xce\x9b\xcf\x8c\xce\x93\xce\x9f\xce\xa3" ) );
+    }
+}
+
+TEST( compile, stats )
+{
+    regex::compile_stats stats;
+    auto automaton = regex::compile( "abc", regex::compile_flag::dfa, regex::language::syntax_flag::none, stats );
+
+    EXPECT_TRUE( automaton->execute( "abc" ) );
+    EXPECT_EQ( stats.ast_nodes, 5u );
+    EXPECT_GE( stats.nfa_states, 4u );
+    EXPECT_GE( stats.nfa_transitions, 3u );
+    EXPECT_EQ( stats.dfa_states, 4u );
+    EXPECT_GT( stats.dfa_bytes, 0u );
+    EXPECT_GE( stats.peak_bytes, stats.dfa_bytes );
+
+    const auto small = stats;
+
+    automaton = regex::compile( "(abc){100}", regex::compile_flag::nfa, regex::language::syntax_flag::none, stats );
+
+    std::string repeated;
+
+    for( int i = 0; i < 100; ++i )
+        repeated += "abc";
+
+    EXPECT_TRUE( automaton->execute( repeated ) );
+    EXPECT_GT( stats.nfa_states, 100 * small.nfa_states / 2 );
+    EXPECT_EQ( stats.dfa_states, 0u );
+    EXPECT_EQ( stats.dfa_bytes, 0u );
+    EXPECT_GT( stats.peak_bytes, small.peak_bytes );
+}
+
+TEST( compile_captures, groups )
+{
+    const auto m = regex::compile_captures( "(a*)(b)" )->capture( "aab" );
+
+    ASSERT_TRUE( m );
+    EXPECT_EQ( *m, ( std::vector<regex::submatch>{ { 0, 3 }, { 0, 2 }, { 2, 3 } } ) );
+}
+
+TEST( compile_captures, nested )
+{
+    const auto m = regex::compile_captures( "((a)(b(c)))d" )->capture( "abcd" );
+
+    ASSERT_TRUE( m );
+    EXPECT_EQ( *m, ( std::vector<regex::submatch>{ { 0, 4 }, { 0, 3 }, { 0, 1 }, { 1, 3 }, { 2, 3 } } ) );
+}
+
+TEST( compile_captures, unmatched )
+{
+    const auto m = regex::compile_captures( "(a)|(b)" )->capture( "b" );
+
+    ASSERT_TRUE( m );
+    EXPECT_EQ( *m, ( std::vector<regex::submatch>{ { 0, 1 }, {}, { 0, 1 } } ) );
+    EXPECT_FALSE( regex::compile_captures( "(a)|(b)" )->capture( "c" ) );
+    EXPECT_FALSE( regex::compile_captures( "(a)|(b)" )->capture( "ab" ) );
+}
+
+TEST( compile_captures, optional )
+{
+    const auto m = regex::compile_captures( "a(b)?c" )->capture( "ac" );
+
+    ASSERT_TRUE( m );
+    EXPECT_EQ( *m, ( std::vector<regex::submatch>{ { 0, 2 }, {} } ) );
+}
+
+TEST( compile_captures, repetition )
+{
+    const auto m = regex::compile_captures( "(ab)+" )->capture( "ababab" );
+
+    ASSERT_TRUE( m );
+    EXPECT_EQ( *m, ( std::vector<regex::submatch>{ { 0, 6 }, { 4, 6 } } ) );
+}
+
+TEST( compile, automatic )
+{
+    regex::compile_stats stats;
+    std::string words;
+
+    for( int i = 0; i < 500; ++i )
+    {
+        words += ( i ? "|w" : "w" ) + std::to_string( i * 7919 );
+    }
+    /*
+     * Literals are compiled to a dfa however many there are
+     */
+    auto automaton = regex::compile( words, regex::compile_flag::automatic, {}, stats );
+
+    EXPECT_EQ( stats.engine, regex::compile_flag::dfa );
+    EXPECT_TRUE( automaton->execute( "w7919" ) );
+    EXPECT_FALSE( automaton->execute( "w7918" ) );
+
+    automaton = regex::compile( "[a-z]+@[a-z]+\\.com", regex::compile_flag::automatic, {}, stats );
+
+    EXPECT_EQ( stats.engine, regex::compile_flag::dfa );
+    EXPECT_EQ( stats.dfa_states, 8u );
+    EXPECT_TRUE( automaton->execute( "user@example.com" ) );
+    /*
+     * The deterministic automaton would have 2^21 states
+     */
+    automaton = regex::compile( "(a|b)*a(a|b){20}", regex::compile_flag::automatic, {}, stats );
+
+    EXPECT_EQ( stats.engine, regex::compile_flag::lazy );
+    EXPECT_EQ( stats.dfa_states, 0u );
+    EXPECT_NE( dynamic_cast<regex::pattern_set *>( automaton.get() ), nullptr );
+    EXPECT_TRUE( automaton->execute( "b" + std::string( 21, 'a' ) ) );
+    EXPECT_FALSE( automaton->execute( "a" + std::string( 20, 'b' ) + "a" ) );
+
+    EXPECT_TRUE(
+        regex::compile( "(a|b)*a(a|b){20}", regex::compile_flag::automatic )->execute( std::string( 21, 'a' ) ) );
+}
+
+TEST( compile, lazy )
+{
+    regex::compile_stats stats;
+    const auto automaton = regex::compile( "error: [a-z]+", regex::compile_flag::lazy,
+                                           regex::language::syntax_flag::case_insensitive, stats );
+
+    EXPECT_EQ( stats.engine, regex::compile_flag::lazy );
+    EXPECT_GT( stats.nfa_states, 0u );
+    EXPECT_TRUE( automaton->execute( "ERROR: disk" ) );
+    EXPECT_FALSE( automaton->execute( "error: 42" ) );
+    EXPECT_TRUE( regex::compile( "a+", regex::compile_flag::lazy )->execute( "aaa" ) );
+}
+
+TEST( compile_captures, greedy )
+{
+    const auto m = regex::compile_captures( "(a*)(a*)" )->capture( "aa" );
+
+    ASSERT_TRUE( m );
+    EXPECT_EQ( *m, ( std::vector<regex::submatch>{ { 0, 2 }, { 0, 2 }, { 2, 2 } } ) );
+}
+
+TEST( compile_captures, leftmost_alternative )
+{
+    const auto m = regex::compile_captures( "(a|ab)(c|bcd)(d*)" )->capture( "abcd" );
+
+    ASSERT_TRUE( m );
+    EXPECT_EQ( *m, ( std::vector<regex::submatch>{ { 0, 4 }, { 0, 1 }, { 1, 4 }, { 4, 4 } } ) );
+}
+
+TEST( compile_captures, repeated )
+{
+    auto automaton = regex::compile_captures( "([a-z]+)=([0-9]*)" );
+
+    for( int i = 0; i < 2; ++i )
+    {
+        const auto m = automaton->capture( "key=42" );
+
+        ASSERT_TRUE( m );
+        EXPECT_EQ( *m, ( std::vector<regex::submatch>{ { 0, 6 }, { 0, 3 }, { 4, 6 } } ) );
+        EXPECT_FALSE( automaton->capture( "key=4a" ) );
+    }
+}
+
+TEST( compile_captures, empty_iteration )
+{
+    // A backtracking matcher ends each repetition with an empty iteration, at the end of the last non-empty one
+    const auto l = regex::compile_captures( "(a?)+" )->capture( "a" );
+
+    ASSERT_TRUE( l );
+    EXPECT_EQ( *l, ( std::vector<regex::submatch>{ { 0, 1 }, { 0, 1 } } ) );
+
+    const auto m = regex::compile_captures( "c?((.?)|[ab]?)+[ab]" )->capture( "caa" );
+
+    ASSERT_TRUE( m );
+    EXPECT_EQ( *m, ( std::vector<regex::submatch>{ { 0, 3 }, { 1, 2 }, { 1, 2 } } ) );
+
+    const auto n = regex::compile_captures( "(.?|.+ca+)+.*" )->capture( "c" );
+
+    ASSERT_TRUE( n );
+    EXPECT_EQ( *n, ( std::vector<regex::submatch>{ { 0, 1 }, { 0, 1 } } ) );
+}
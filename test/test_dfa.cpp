@@ -75,4 +75,78 @@ TEST( dfa, complex )
 
     EXPECT_FALSE( state_machine->execute( "e" ) );
     EXPECT_FALSE( state_machine->execute( "bc" ) );
-}
\ No newline at end of file
+}
+
+TEST( dfa, large )
+{
+    auto expression = regex::nfa::from_character( 'a' );
+
+    for( int i = 0; i < 4096; ++i )
+    {
+        expression = regex::nfa::from_concatenation(
+            std::move( expression ), regex::nfa::from_alternation( regex::nfa::from_character( 'a' ),
+                                                                   regex::nfa::from_character( 'b' ) ) );
+    }
+
+    auto state_machine = expression->to_dfa();
+
+    std::string accepted( 4097, 'a' );
+
+    for( std::size_t i = 2; i < accepted.size(); i += 3 )
+        accepted[i] = 'b';
+
+    EXPECT_TRUE( state_machine->execute( std::string( 4097, 'a' ) ) );
+    EXPECT_TRUE( state_machine->execute( accepted ) );
+    EXPECT_FALSE( state_machine->execute( accepted.substr( 1 ) ) );
+    EXPECT_FALSE( state_machine->execute( accepted + 'a' ) );
+    EXPECT_FALSE( state_machine->execute( "b" ) );
+    EXPECT_FALSE( state_machine->execute( "ab" ) );
+}
+
+TEST( dfa, budget )
+{
+    /*
+     * (a|b)*a(a|b)(a|b)(a|b), whose deterministic states remember the last four characters, along with the
+     * input state
+     */
+    auto expression = regex::nfa::from_concatenation(
+        regex::nfa::from_kleene(
+            regex::nfa::from_alternation( regex::nfa::from_character( 'a' ), regex::nfa::from_character( 'b' ) ) ),
+        regex::nfa::from_character( 'a' ) );
+
+    for( int i = 0; i < 3; ++i )
+    {
+        expression = regex::nfa::from_concatenation(
+            std::move( expression ), regex::nfa::from_alternation( regex::nfa::from_character( 'a' ),
+                                                                   regex::nfa::from_character( 'b' ) ) );
+    }
+
+    EXPECT_EQ( expression->to_dfa( nullptr, 16 ), nullptr );
+
+    const auto state_machine = expression->to_dfa( nullptr, 1 << 12 );
+
+    ASSERT_NE( state_machine, nullptr );
+    EXPECT_EQ( state_machine->size(), 17u );
+    EXPECT_TRUE( state_machine->execute( "babab" ) );
+    EXPECT_FALSE( state_machine->execute( "abbbb" ) );
+}
+
+TEST( dfa, one_or_more )
+{
+    EXPECT_FALSE( regex::nfa::from_one_or_more( regex::nfa::from_character( 'a' ) )->to_dfa()->execute( "" ) );
+    EXPECT_TRUE( regex::nfa::from_one_or_more( regex::nfa::from_character( 'a' ) )->to_dfa()->execute( "a" ) );
+    EXPECT_TRUE( regex::nfa::from_one_or_more( regex::nfa::from_character( 'a' ) )->to_dfa()->execute( "aa" ) );
+    EXPECT_FALSE( regex::nfa::from_one_or_more( regex::nfa::from_character( 'a' ) )->to_dfa()->execute( "ab" ) );
+}
+
+TEST( dfa, character_class )
+{
+    regex::language::character_class letters( 'a', 'z' );
+    auto state_machine = regex::nfa::from_alternation( regex::nfa::from_class( letters ),
+                                                       regex::nfa::from_character( 'q' ) )
+                             ->to_dfa();
+
+    EXPECT_TRUE( state_machine->execute( "a" ) );
+    EXPECT_TRUE( state_machine->execute( "q" ) );
+    EXPECT_FALSE( state_machine->execute( "A" ) );
+}
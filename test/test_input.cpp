@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "regex/utilities/input.h"
+
+static std::string read_all( regex::input &file, std::vector<std::size_t> *sizes = nullptr )
+{
+    std::string contents;
+
+    for( auto block = file.next(); !block.empty(); block = file.next() )
+    {
+        contents += block;
+
+        if( sizes )
+            sizes->push_back( block.size() );
+    }
+
+    return contents;
+}
+
+TEST( input, mapped )
+{
+    const auto path = std::filesystem::temp_directory_path() / "regex_test_input_mapped";
+    const std::string contents = "first\nsecond\nlast without newline";
+
+    std::ofstream( path ) << contents;
+
+    regex::input file( path );
+    std::vector<std::size_t> sizes;
+
+    EXPECT_EQ( read_all( file, &sizes ), contents );
+    EXPECT_EQ( sizes, std::vector<std::size_t>{ contents.size() } );
+
+    std::filesystem::remove( path );
+}
+
+TEST( input, empty )
+{
+    const auto path = std::filesystem::temp_directory_path() / "regex_test_input_empty";
+
+    std::ofstream{ path };
+
+    regex::input file( path );
+
+    EXPECT_TRUE( file.next().empty() );
+
+    std::filesystem::remove( path );
+}
+
+TEST( input, missing )
+{
+    EXPECT_THROW( regex::input( "/nonexistent/regex_test_input" ), std::system_error );
+}
+
+TEST( input, pipe )
+{
+    int descriptors[2];
+    ASSERT_EQ( ::pipe( descriptors ), 0 );
+
+    /*
+     * Lines longer than the buffer force it to grow, and blocks must still end on whole lines
+     */
+    std::string contents;
+
+    for( std::size_t i = 0; i < 64; ++i )
+        contents += std::string( i * regex::input::buffer_size / 16, 'a' + i % 26 ) + '\n';
+    contents += "tail";
+
+    const auto saved = ::dup( STDIN_FILENO );
+    ::dup2( descriptors[0], STDIN_FILENO );
+    ::close( descriptors[0] );
+
+    std::FILE *writer = ::fdopen( descriptors[1], "w" );
+    std::string read;
+    std::vector<std::size_t> sizes;
+
+    {
+        /*
+         * The pipe holds far less than the contents, so write and read concurrently
+         */
+        std::thread write( [&]() {
+            std::fwrite( contents.data(), 1, contents.size(), writer );
+            std::fclose( writer );
+        } );
+
+        regex::input file( "-" );
+        read = read_all( file, &sizes );
+        write.join();
+    }
+
+    ::dup2( saved, STDIN_FILENO );
+    ::close( saved );
+
+    EXPECT_EQ( read, contents );
+    ASSERT_GT( sizes.size(), 1u );
+
+    std::size_t offset = 0;
+
+    for( std::size_t i = 0; i + 1 < sizes.size(); ++i )
+    {
+        offset += sizes[i];
+        EXPECT_EQ( contents[offset - 1], '\n' );
+    }
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "regex/utilities/compile.h"
+#include "regex/utilities/matcher.h"
+
+using records = std::vector<std::pair<regex::matcher::offset_type, regex::matcher::offset_type>>;
+
+static records match( regex::fa &automata, const std::vector<std::string> &chunks,
+                      std::optional<char> delimiter = '\n' )
+{
+    records result;
+    regex::matcher m( automata, [&result]( auto begin, auto end ) { result.emplace_back( begin, end ); },
+                      delimiter );
+
+    for( const auto &chunk : chunks )
+        m.feed( chunk );
+
+    m.finish();
+
+    return result;
+}
+
+TEST( matcher, lines )
+{
+    for( const auto flag : { regex::compile_flag::nfa, regex::compile_flag::dfa } )
+    {
+        auto automata = regex::compile( "ab*c", flag );
+
+        EXPECT_EQ( match( *automata, { "abbc\nxx\nac\n" } ), ( records{ { 0, 4 }, { 8, 10 } } ) );
+    }
+}
+
+TEST( matcher, chunk_boundaries )
+{
+    for( const auto flag : { regex::compile_flag::nfa, regex::compile_flag::dfa } )
+    {
+        auto automata = regex::compile( "ab*c", flag );
+
+        EXPECT_EQ( match( *automata, { "a", "bb", "c", "\nx", "x\na", "c" } ), ( records{ { 0, 4 }, { 8, 10 } } ) );
+        EXPECT_EQ( match( *automata, { "abc", "\n", "\n", "abbbbc" } ), ( records{ { 0, 3 }, { 5, 11 } } ) );
+    }
+}
+
+TEST( matcher, dead_record )
+{
+    auto automata = regex::compile( "a*", regex::compile_flag::dfa );
+
+    EXPECT_EQ( match( *automata, { "aab", "aa\naaa", "a\n" } ), ( records{ { 6, 10 } } ) );
+}
+
+TEST( matcher, empty_records )
+{
+    auto automata = regex::compile( "a*", regex::compile_flag::nfa );
+
+    EXPECT_EQ( match( *automata, { "\n\na\n" } ), ( records{ { 0, 0 }, { 1, 1 }, { 2, 3 } } ) );
+    EXPECT_EQ( match( *automata, {} ), records{} );
+}
+
+TEST( matcher, whole_stream )
+{
+    auto automata = regex::compile( "a(\\n|b)*c", regex::compile_flag::dfa );
+
+    EXPECT_EQ( match( *automata, { "ab\n", "b\nc" }, std::nullopt ), ( records{ { 0, 6 } } ) );
+    EXPECT_EQ( match( *automata, { "ab\n", "b\n" }, std::nullopt ), records{} );
+}
+
+TEST( matcher, restart )
+{
+    auto automata = regex::compile( "ab", regex::compile_flag::nfa );
+    records result;
+    regex::matcher m( *automata, [&result]( auto begin, auto end ) { result.emplace_back( begin, end ); } );
+
+    m.feed( "x\na" );
+    m.finish();
+    m.feed( "ab" );
+    m.finish();
+
+    EXPECT_EQ( result, ( records{ { 0, 2 } } ) );
+}
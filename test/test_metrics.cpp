@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "regex/utilities/compile.h"
+#include "regex/utilities/metrics.h"
+
+using regex::metrics::counter;
+
+TEST( metrics, engines )
+{
+    const auto nfa = regex::compile( "a+b", regex::compile_flag::nfa );
+    const auto dfa = regex::compile( "a+b", regex::compile_flag::dfa );
+    const auto before = regex::metrics::collect();
+
+    EXPECT_TRUE( nfa->execute( "aaab" ) );
+    EXPECT_FALSE( dfa->execute( "aacb" ) );
+
+    const auto after = regex::metrics::collect();
+
+    if constexpr ( regex::metrics::enabled )
+    {
+        EXPECT_EQ( after[counter::bytes] - before[counter::bytes], 4u + 3u );
+        EXPECT_GE( after[counter::transitions] - before[counter::transitions], 4u + 2u );
+        EXPECT_GE( after.active_states_sum - before.active_states_sum, 4u );
+
+        std::uint64_t characters = 0;
+
+        for ( std::size_t bucket = 0; bucket < regex::metrics::buckets; ++bucket )
+        {
+            characters += after.active_states[bucket] - before.active_states[bucket];
+        }
+
+        EXPECT_EQ( characters, 4u );
+    }
+    else
+    {
+        EXPECT_EQ( after.values, before.values );
+        EXPECT_EQ( after[counter::bytes], 0u );
+    }
+}
+
+TEST( metrics, dead_state )
+{
+    /*
+     * Every engine reads the character without a transition but takes none for it
+     */
+    const auto transitions = []( regex::fa &automata ) {
+        const auto before = regex::metrics::collect();
+
+        EXPECT_FALSE( automata.execute( "abxc" ) );
+
+        return regex::metrics::collect()[counter::transitions] - before[counter::transitions];
+    };
+
+    const auto nfa = regex::compile( "abc", regex::compile_flag::nfa );
+    const auto dfa = regex::compile( "abc", regex::compile_flag::dfa );
+    const auto lazy = regex::compile( "abc", regex::compile_flag::lazy );
+    const auto expected = regex::metrics::enabled ? 2u : 0u;
+
+    EXPECT_EQ( transitions( *nfa ), expected );
+    EXPECT_EQ( transitions( *dfa ), expected );
+    EXPECT_EQ( transitions( *lazy ), expected );
+
+    const auto cursor = dfa->make_cursor();
+    const auto before = regex::metrics::collect();
+
+    EXPECT_FALSE( cursor->advance( "abxc" ) );
+    EXPECT_EQ( regex::metrics::collect()[counter::transitions] - before[counter::transitions], expected );
+}
+
+TEST( metrics, lazy )
+{
+    const auto set = regex::compile_patterns( { "a+", "b" } );
+    auto c = set->make_pattern_cursor();
+    const auto before = regex::metrics::collect();
+
+    c->advance( "aaaa" );
+    c->reset();
+    c->advance( "aaaa" );
+
+    const auto after = regex::metrics::collect();
+
+    if constexpr ( regex::metrics::enabled )
+    {
+        EXPECT_EQ( after[counter::bytes] - before[counter::bytes], 8u );
+        EXPECT_EQ( after[counter::cache_misses] - before[counter::cache_misses], 2u );
+    }
+    else
+    {
+        EXPECT_EQ( after[counter::cache_misses], 0u );
+    }
+}
+
+TEST( metrics, finished_threads )
+{
+    const auto automaton = regex::compile( "x*", regex::compile_flag::dfa );
+    const auto before = regex::metrics::collect();
+
+    std::thread( [&automaton]() { automaton->execute( std::string( 100, 'x' ) ); } ).join();
+
+    const auto after = regex::metrics::collect();
+
+    EXPECT_EQ( after[counter::bytes] - before[counter::bytes], regex::metrics::enabled ? 100u : 0u );
+}
+
+TEST( metrics, write )
+{
+    regex::metrics::snapshot s;
+    s.values[static_cast<std::size_t>( counter::bytes )] = 42;
+    s.active_states[0] = 3;
+    s.active_states[2] = 1;
+    s.active_states_sum = 7;
+
+    std::ostringstream output;
+    regex::metrics::write( output, s );
+    const auto text = output.str();
+
+    EXPECT_NE( text.find( "# TYPE regex_bytes_total counter\nregex_bytes_total 42\n" ), std::string::npos );
+    EXPECT_NE( text.find( "regex_active_states_bucket{le=\"1\"} 3\n" ), std::string::npos );
+    EXPECT_NE( text.find( "regex_active_states_bucket{le=\"7\"} 4\n" ), std::string::npos );
+    EXPECT_NE( text.find( "regex_active_states_bucket{le=\"+Inf\"} 4\n" ), std::string::npos );
+    EXPECT_NE( text.find( "regex_active_states_sum 7\nregex_active_states_count 4\n" ), std::string::npos );
+}
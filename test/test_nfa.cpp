@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "regex/automata/nfa.h"
+#include "regex/utilities/compile.h"
 
 TEST(nfa, character) {
     EXPECT_TRUE(regex::nfa::from_character('a')->execute("a"));
@@ -65,4 +66,75 @@ TEST(nfa, complex) {
     EXPECT_TRUE(state_machine->execute("dd"));
     EXPECT_FALSE(state_machine->execute("e"));
     EXPECT_FALSE(state_machine->execute("bc"));
-}
\ No newline at end of file
+}
+TEST(nfa, pathological) {
+    const int n = 64;
+    auto state_machine = regex::nfa::from_epsilon();
+    for (int i = 0; i < n; ++i)
+        state_machine = regex::nfa::from_concatenation(
+            std::move(state_machine),
+            regex::nfa::from_alternation(regex::nfa::from_epsilon(), regex::nfa::from_character('a')));
+    for (int i = 0; i < n; ++i)
+        state_machine =
+            regex::nfa::from_concatenation(std::move(state_machine), regex::nfa::from_character('a'));
+
+    EXPECT_TRUE(state_machine->execute(std::string(n, 'a')));
+    EXPECT_TRUE(state_machine->execute(std::string(2 * n, 'a')));
+    EXPECT_FALSE(state_machine->execute(std::string(n - 1, 'a')));
+    EXPECT_FALSE(state_machine->execute(std::string(2 * n + 1, 'a')));
+}
+
+TEST(nfa, one_or_more) {
+    EXPECT_FALSE(regex::nfa::from_one_or_more(regex::nfa::from_character('a'))->execute(""));
+    EXPECT_TRUE(regex::nfa::from_one_or_more(regex::nfa::from_character('a'))->execute("a"));
+    EXPECT_TRUE(regex::nfa::from_one_or_more(regex::nfa::from_character('a'))->execute("aa"));
+    EXPECT_FALSE(regex::nfa::from_one_or_more(regex::nfa::from_character('a'))->execute("ab"));
+}
+
+TEST(nfa, character_class) {
+    regex::language::character_class digits('0', '9');
+    EXPECT_TRUE(regex::nfa::from_class(digits)->execute("5"));
+    EXPECT_FALSE(regex::nfa::from_class(digits)->execute("a"));
+    EXPECT_TRUE(regex::nfa::from_class(digits.complement())->execute("a"));
+}
+
+TEST(nfa, repetition) {
+    EXPECT_TRUE(regex::nfa::from_repetition(regex::nfa::from_character('a'), 2, 3)->execute("aa"));
+    EXPECT_TRUE(regex::nfa::from_repetition(regex::nfa::from_character('a'), 2, 3)->execute("aaa"));
+    EXPECT_FALSE(regex::nfa::from_repetition(regex::nfa::from_character('a'), 2, 3)->execute("a"));
+    EXPECT_FALSE(regex::nfa::from_repetition(regex::nfa::from_character('a'), 2, 3)->execute("aaaa"));
+}
+
+TEST(nfa, execute_reused) {
+    auto state_machine = regex::nfa::from_character('a');
+
+    EXPECT_TRUE(state_machine->execute("a"));
+    EXPECT_FALSE(state_machine->execute("aa"));
+
+    state_machine = regex::nfa::from_concatenation(std::move(state_machine), regex::nfa::from_character('b'));
+
+    EXPECT_TRUE(state_machine->execute("ab"));
+    EXPECT_FALSE(state_machine->execute("a"));
+
+    state_machine = regex::nfa::from_kleene(std::move(state_machine));
+
+    EXPECT_TRUE(state_machine->execute("abab"));
+    EXPECT_TRUE(state_machine->execute(""));
+
+    regex::nfa copy(*state_machine);
+
+    EXPECT_TRUE(copy.execute("ab"));
+    EXPECT_FALSE(copy.execute("aba"));
+}
+
+TEST(nfa, empty_iterations) {
+    using groups = std::vector<regex::submatch>;
+    /*
+     * A * or + repetition takes no empty iteration after a non-empty one, the optional copies of {m,n} do
+     */
+    EXPECT_EQ(*regex::compile_captures("(a?)+")->capture("a"), (groups{{0, 1}, {0, 1}}));
+    EXPECT_EQ(*regex::compile_captures("(a?)*")->capture("a"), (groups{{0, 1}, {0, 1}}));
+    EXPECT_EQ(*regex::compile_captures("(a?){1,2}")->capture("a"), (groups{{0, 1}, {1, 1}}));
+    EXPECT_EQ(*regex::compile_captures("(a?){2,3}")->capture("a"), (groups{{0, 1}, {1, 1}}));
+    EXPECT_EQ(*regex::compile_captures("((a*|.)+){1,2}")->capture("ab"), (groups{{0, 2}, {2, 2}, {2, 2}}));
+}
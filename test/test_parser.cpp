@@ -67,6 +67,75 @@ TEST( parse, complex )
     EXPECT_EQ( output, input );
 }
 
+TEST( parse, character_class )
+{
+    std::string input( "[0-9_a-z]+x" );
+    std::string output = regex::language::to_string( regex::language::parse<pool_allocator<regex::language::token>>( input ) );
+
+    EXPECT_EQ( output, input );
+}
+
+TEST( parse, negated_character_class )
+{
+    std::string input( "[^\\]a-c]" );
+    std::string output = regex::language::to_string( regex::language::parse<pool_allocator<regex::language::token>>( input ) );
+
+    EXPECT_EQ( output, input );
+}
+
+TEST( parse, shorthand_character_class )
+{
+    EXPECT_EQ( regex::language::to_string( regex::language::parse<pool_allocator<regex::language::token>>( "\\d\\w" ) ),
+               "[0-9][0-9A-Z_a-z]" );
+    EXPECT_EQ( regex::language::to_string( regex::language::parse<pool_allocator<regex::language::token>>( "\\S" ) ),
+               "[^\\x09-\\x0d ]" );
+    EXPECT_EQ( regex::language::to_string( regex::language::parse<pool_allocator<regex::language::token>>( "\\*\\x41" ) ),
+               "\\*A" );
+}
+
+TEST( parse, repetition )
+{
+    std::string input( "a{2,5}b{3}(cd){1,}e*{2}" );
+    std::string output = regex::language::to_string( regex::language::parse<pool_allocator<regex::language::token>>( input ) );
+
+    EXPECT_EQ( output, input );
+}
+
+TEST( parse, concatenated_alternation )
+{
+    std::string input( "ab|c" );
+    std::string output = regex::language::to_string( regex::language::parse<pool_allocator<regex::language::token>>( input ) );
+
+    EXPECT_EQ( output, input );
+}
+
+TEST( parse, literal_hyphen )
+{
+    EXPECT_EQ( regex::language::to_string( regex::language::parse<pool_allocator<regex::language::token>>( "a-b" ) ),
+               "a\\-b" );
+}
+
+TEST( parse, case_insensitive )
+{
+    const auto flags = regex::language::syntax_flag::case_insensitive;
+
+    EXPECT_EQ( regex::language::to_string( regex::language::parse( "a1[b-dX]", flags ) ), "[Aa]1[B-DXb-dx]" );
+    EXPECT_EQ( regex::language::to_string( regex::language::parse( "[^a]", flags ) ), "[^Aa]" );
+    EXPECT_EQ( regex::language::to_string( regex::language::parse( "\\x41", flags ) ), "[Aa]" );
+}
+
+TEST( parse, deep )
+{
+    std::string concatenation( 100000, 'a' );
+    std::string nesting = std::string( regex::language::nesting_limit, '(' ) + "a" +
+                          std::string( regex::language::nesting_limit, ')' );
+
+    EXPECT_NO_THROW( regex::language::parse<pool_allocator<regex::language::token>>( concatenation ) );
+    EXPECT_NO_THROW( regex::language::parse<pool_allocator<regex::language::token>>( nesting ) );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "(" + nesting + ")" ),
+                  std::runtime_error );
+}
+
 TEST( parse, invalid )
 {
     EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "" ),   std::runtime_error );
@@ -76,4 +145,15 @@ TEST( parse, invalid )
     EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "a|" ), std::runtime_error );
     EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "*" ),  std::runtime_error );
     EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "+" ),  std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "[a" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "[z-a]" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "a\\" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "{2}" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "a{2" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "a{5,2}" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "a{,2}" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "a{1001}" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "(a" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "a)" ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse<pool_allocator<regex::language::token>>( "a()" ), std::runtime_error );
 }
\ No newline at end of file
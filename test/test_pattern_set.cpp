@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "regex/automata/pattern_set.h"
+#include "regex/utilities/compile.h"
+
+using ids = std::vector<regex::pattern_set::pattern_id>;
+
+TEST( pattern_set, matches )
+{
+    const auto set = regex::compile_patterns( { "error.*", ".*timeout", "[0-9]+", "error [0-9]+" } );
+
+    EXPECT_EQ( set->size(), 4u );
+    EXPECT_EQ( set->matches( "error 42" ), ( ids{ 0, 3 } ) );
+    EXPECT_EQ( set->matches( "error timeout" ), ( ids{ 0, 1 } ) );
+    EXPECT_EQ( set->matches( "1234" ), ( ids{ 2 } ) );
+    EXPECT_EQ( set->matches( "warning" ), ids{} );
+    EXPECT_TRUE( set->execute( "timeout" ) );
+    EXPECT_FALSE( set->execute( "time" ) );
+}
+
+TEST( pattern_set, empty )
+{
+    const auto set = regex::compile_patterns( { "", "a*" } );
+
+    EXPECT_EQ( set->matches( "" ), ( ids{ 0, 1 } ) );
+    EXPECT_EQ( set->matches( "aa" ), ( ids{ 1 } ) );
+    EXPECT_FALSE( regex::compile_patterns( {} )->execute( "" ) );
+}
+
+TEST( pattern_set, cursor )
+{
+    const auto set = regex::compile_patterns( { "abc", "ab.*", "x" } );
+    auto c = set->make_pattern_cursor();
+
+    for( int run = 0; run < 2; ++run )
+    {
+        c->reset();
+        EXPECT_TRUE( c->advance( "a" ) );
+        EXPECT_FALSE( c->accepted() );
+        EXPECT_TRUE( c->advance( "bc" ) );
+        EXPECT_EQ( ids( c->patterns().begin(), c->patterns().end() ), ( ids{ 0, 1 } ) );
+        EXPECT_TRUE( c->advance( "d" ) );
+        EXPECT_EQ( ids( c->patterns().begin(), c->patterns().end() ), ( ids{ 1 } ) );
+    }
+
+    c->reset();
+    EXPECT_FALSE( c->advance( "y" ) );
+    EXPECT_FALSE( c->accepted() );
+}
+
+TEST( pattern_set, repeated )
+{
+    const auto set = regex::compile_patterns( { "ab", "a+" } );
+    /*
+     * Each call starts from the input state, whatever the last one stopped in
+     */
+    for( int run = 0; run < 2; ++run )
+    {
+        EXPECT_EQ( set->matches( "ab" ), ( ids{ 0 } ) );
+        EXPECT_FALSE( set->execute( "b" ) );
+        EXPECT_EQ( set->matches( "aaa" ), ( ids{ 1 } ) );
+        EXPECT_EQ( set->matches( "" ), ids{} );
+        EXPECT_TRUE( set->execute( "a" ) );
+    }
+}
+
+TEST( pattern_set, syntax )
+{
+    const auto set = regex::compile_patterns( { "error", "[^a]" }, regex::language::syntax_flag::case_insensitive |
+                                                                       regex::language::syntax_flag::utf8 );
+
+    EXPECT_EQ( set->matches( "ERROR" ), ( ids{ 0 } ) );
+    EXPECT_EQ( set->matches( "\xc3\xa9" ), ( ids{ 1 } ) );
+}
+
+TEST( pattern_set, invalid )
+{
+    try
+    {
+        regex::compile_patterns( { "a", "(b" } );
+        FAIL();
+    }
+    catch( const std::runtime_error &e )
+    {
+        EXPECT_EQ( std::string( e.what() ).rfind( "Pattern 2: ", 0 ), 0u );
+    }
+}
+/*
+ * Enough states to fill the cache of a cursor several times over, which must go on matching as the
+ * non-deterministic automaton does after starting over
+ */
+TEST( pattern_set, start_over )
+{
+    const auto set = regex::compile_patterns( { "(a|b)*a(a|b){14}", "(a|b)*bbbb" } );
+    const auto first = regex::compile_nfa( "(a|b)*a(a|b){14}" ), second = regex::compile_nfa( "(a|b)*bbbb" );
+    auto c = set->make_pattern_cursor();
+    auto first_cursor = first->make_cursor(), second_cursor = second->make_cursor();
+    std::mt19937 random( 42 );
+    const std::string input = "ab";
+
+    for( int i = 0; i < 200000; ++i )
+    {
+        const auto character = input.substr( random() % 2, 1 );
+
+        ASSERT_TRUE( c->advance( character ) );
+        first_cursor->advance( character );
+        second_cursor->advance( character );
+
+        ids expected;
+
+        if( first_cursor->accepted() )
+            expected.push_back( 0 );
+        if( second_cursor->accepted() )
+            expected.push_back( 1 );
+
+        ASSERT_EQ( ids( c->patterns().begin(), c->patterns().end() ), expected ) << i;
+    }
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "regex/utilities/compile.h"
+#include "regex/utilities/metrics.h"
+#include "regex/utilities/search.h"
+
+class search : public ::testing::Test
+{
+  protected:
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "regex_test_search";
+
+    void SetUp() override
+    {
+        std::filesystem::remove_all( root );
+        std::filesystem::create_directories( root / "nested" );
+
+        std::ofstream large( root / "large.log" );
+
+        for( int i = 0; i < 10000; ++i )
+            large << ( i % 7 == 0 ? "error " : "info " ) << i << '\n';
+
+        std::ofstream( root / "nested" / "small.log" ) << "error 1\ninfo 2\nerror 3";
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all( root );
+    }
+
+    std::string run( regex::search_options options, const std::vector<std::filesystem::path> &targets,
+                     std::string *errors = nullptr )
+    {
+        auto automata = regex::compile( "error.*", regex::compile_flag::dfa );
+        std::ostringstream output, error_output;
+        regex::searcher s( *automata, output, options );
+
+        s.search( targets, error_output );
+
+        if( errors )
+            *errors = error_output.str();
+
+        return output.str();
+    }
+};
+
+TEST_F( search, ordered )
+{
+    const auto expected = run( {}, { root / "large.log" } );
+
+    EXPECT_EQ( std::count( std::cbegin( expected ), std::cend( expected ), '\n' ), 10000 / 7 + 1 );
+    EXPECT_EQ( expected.substr( 0, 16 ), "error 0\nerror 7\n" );
+
+    for( const std::size_t threads : { 2, 8 } )
+    {
+        regex::search_options options;
+        options.threads = threads;
+        options.chunk_size = 100;
+
+        EXPECT_EQ( run( options, { root / "large.log" } ), expected );
+    }
+}
+
+TEST_F( search, directories )
+{
+    regex::search_options options;
+    options.threads = 4;
+    options.with_filename = true;
+
+    const auto output = run( options, { root } );
+    const auto small = ( root / "nested" / "small.log" ).string();
+
+    EXPECT_NE( output.find( small + ":error 1\n" + small + ":error 3\n" ), std::string::npos );
+    EXPECT_NE( output.find( ( root / "large.log" ).string() + ":error 9996\n" ), std::string::npos );
+}
+
+TEST_F( search, missing )
+{
+    std::string errors;
+    const auto output = run( {}, { root / "missing.log", root / "nested" / "small.log" }, &errors );
+
+    EXPECT_EQ( output, "error 1\nerror 3\n" );
+    EXPECT_NE( errors.find( "missing.log" ), std::string::npos );
+}
+
+TEST_F( search, modes )
+{
+    const std::vector<std::filesystem::path> targets{ root / "large.log", root / "nested" / "small.log" };
+
+    for( const std::size_t threads : { 1, 4 } )
+    {
+        regex::search_options options;
+        options.threads = threads;
+        options.chunk_size = 100;
+        options.with_filename = true;
+
+        options.mode = regex::search_mode::count;
+        EXPECT_EQ( run( options, targets ),
+                   targets[0].string() + ":1429\n" + targets[1].string() + ":2\n" );
+
+        options.max_count = 2;
+        EXPECT_EQ( run( options, targets ), targets[0].string() + ":2\n" + targets[1].string() + ":2\n" );
+
+        options.mode = regex::search_mode::lines;
+        EXPECT_EQ( run( options, targets ), targets[0].string() + ":error 0\n" + targets[0].string() +
+                                                ":error 7\n" + targets[1].string() + ":error 1\n" +
+                                                targets[1].string() + ":error 3\n" );
+
+        options.max_count = 0;
+        options.mode = regex::search_mode::files;
+        EXPECT_EQ( run( options, { root / "missing.log", targets[0], targets[1] } ),
+                   targets[0].string() + "\n" + targets[1].string() + "\n" );
+
+        options.mode = regex::search_mode::quiet;
+        EXPECT_EQ( run( options, targets ), "" );
+    }
+}
+
+TEST_F( search, quiet_stops )
+{
+    auto automata = regex::compile( "error.*", regex::compile_flag::dfa );
+    std::ostringstream output, errors;
+    regex::search_options options;
+    options.mode = regex::search_mode::quiet;
+
+    regex::searcher s( *automata, output, options );
+
+    EXPECT_TRUE( s.search( { root / "nested" / "small.log", root / "missing.log" }, errors ) );
+    EXPECT_EQ( s.matches(), 1u );
+    EXPECT_EQ( errors.str(), "" );
+}
+
+TEST_F( search, patterns )
+{
+    const auto set = regex::compile_patterns( { "error.*", ".*3", "info.*" } );
+    std::ostringstream output, errors;
+
+    for( const std::size_t threads : { 1, 4 } )
+    {
+        regex::search_options options;
+        options.threads = threads;
+
+        regex::searcher s( *set, output, options );
+
+        EXPECT_TRUE( s.search( { root / "nested" / "small.log" }, errors ) );
+        EXPECT_EQ( output.str(), "1:error 1\n3:info 2\n1,2:error 3\n" );
+        output.str( "" );
+    }
+}
+
+TEST_F( search, patterns_standard_input )
+{
+    const auto set = regex::compile_patterns( { "error.*", ".*3", "info.*" } );
+    std::ostringstream output, errors;
+    regex::searcher s( *set, output, {} );
+
+    const auto saved = ::dup( STDIN_FILENO );
+    const auto file = ::open( ( root / "nested" / "small.log" ).c_str(), O_RDONLY );
+    ::dup2( file, STDIN_FILENO );
+    ::close( file );
+
+    const auto found = s.search( { "-" }, errors );
+
+    ::dup2( saved, STDIN_FILENO );
+    ::close( saved );
+
+    EXPECT_TRUE( found );
+    EXPECT_EQ( output.str(), "1:error 1\n3:info 2\n1,2:error 3\n" );
+}
+
+TEST_F( search, destroyed_after_search )
+{
+    auto automata = regex::compile( "error.*", regex::compile_flag::dfa );
+    regex::search_options options;
+    options.threads = 4;
+    options.chunk_size = 256;
+
+    for( int i = 0; i < 20; ++i )
+    {
+        std::ostringstream output, errors;
+
+        {
+            regex::searcher s( *automata, output, options );
+            EXPECT_TRUE( s.search( { root / "large.log" }, errors ) );
+        }
+
+        const auto written = output.str();
+
+        EXPECT_EQ( std::count( std::cbegin( written ), std::cend( written ), '\n' ), 1429 );
+    }
+}
+
+TEST_F( search, cursor_kept )
+{
+    const auto set = regex::compile_patterns( { "error.*", ".*3", "info.*" } );
+    std::ostringstream output, errors;
+    regex::search_options options;
+    options.chunk_size = 256;
+    /*
+     * The states built for the first chunk serve every later chunk and file, so searching again builds none
+     */
+    regex::searcher s( *set, output, options );
+    s.search( { root / "large.log" }, errors );
+
+    const auto before = regex::metrics::collect();
+
+    s.search( { root / "large.log", root / "nested" / "small.log" }, errors );
+
+    const auto after = regex::metrics::collect();
+
+    EXPECT_EQ( after[regex::metrics::counter::cache_misses], before[regex::metrics::counter::cache_misses] );
+}
+
+TEST_F( search, scanned )
+{
+    auto automata = regex::compile( "error.*", regex::compile_flag::dfa );
+    std::ostringstream output, errors;
+    regex::search_options options;
+
+    regex::searcher s( *automata, output, options );
+    s.search( { root / "nested" / "small.log" }, errors );
+
+    EXPECT_EQ( s.bytes(), 22u );
+    EXPECT_EQ( s.lines(), 3u );
+
+    options.mode = regex::search_mode::files;
+
+    regex::searcher first( *automata, output, options );
+    first.search( { root / "nested" / "small.log" }, errors );
+
+    EXPECT_EQ( first.bytes(), 8u );
+    EXPECT_EQ( first.lines(), 1u );
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "regex/language/ast.h"
+#include "regex/language/simplify.h"
+
+static std::string simplified( const std::string &input )
+{
+    auto a = regex::language::parse<pool_allocator<regex::language::token>>( input );
+    regex::language::simplify( a );
+
+    return regex::language::to_string( a );
+}
+
+TEST( simplify, nested_closure )
+{
+    EXPECT_EQ( simplified( "a**" ), "a*" );
+    EXPECT_EQ( simplified( "(a*)?" ), "a*" );
+    EXPECT_EQ( simplified( "(a+)?" ), "a*" );
+    EXPECT_EQ( simplified( "a++" ), "a+" );
+    EXPECT_EQ( simplified( "a??" ), "a?" );
+}
+
+TEST( simplify, redundant_group )
+{
+    EXPECT_EQ( simplified( "((a))" ), "a" );
+    EXPECT_EQ( simplified( "(ab)c" ), "abc" );
+    EXPECT_EQ( simplified( "(ab)*" ), "(ab)*" );
+}
+
+TEST( simplify, repetition )
+{
+    EXPECT_EQ( simplified( "a{1}" ), "a" );
+    EXPECT_EQ( simplified( "a{0,1}" ), "a?" );
+    EXPECT_EQ( simplified( "a{0,}" ), "a*" );
+    EXPECT_EQ( simplified( "a{1,}" ), "a+" );
+    EXPECT_EQ( simplified( "a{2,3}" ), "a{2,3}" );
+}
+
+TEST( simplify, single_character_alternation )
+{
+    EXPECT_EQ( simplified( "a|b|c" ), "[a-c]" );
+    EXPECT_EQ( simplified( "a|[b-d]|x" ), "[a-dx]" );
+    EXPECT_EQ( simplified( "(a|b)c" ), "[ab]c" );
+}
+
+TEST( simplify, common_prefix )
+{
+    EXPECT_EQ( simplified( "foo|foobar|fox" ), "fo(o(bar)?|x)" );
+    EXPECT_EQ( simplified( "ab|ac" ), "a[bc]" );
+    EXPECT_EQ( simplified( "abc|abc" ), "abc" );
+    EXPECT_EQ( simplified( "ab|cd|ae" ), "ab|cd|ae" );
+}
+
+TEST( simplify, deep )
+{
+    EXPECT_EQ( simplified( "a" + std::string( 100000, '*' ) ), "a*" );
+    EXPECT_EQ( simplified( std::string( 100000, 'a' ) ), std::string( 100000, 'a' ) );
+}
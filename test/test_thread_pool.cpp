@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "regex/utilities/thread_pool.h"
+
+TEST( thread_pool, runs_every_task )
+{
+    std::atomic<int> count = 0;
+
+    {
+        regex::thread_pool pool( 4 );
+
+        for( int i = 0; i < 10000; ++i )
+            pool.submit( [&count]() { ++count; } );
+    }
+
+    EXPECT_EQ( count, 10000 );
+}
+
+TEST( thread_pool, steals )
+{
+    std::atomic<int> count = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    {
+        regex::thread_pool pool( 4 );
+        /*
+         * Every fourth task is slow and lands on the same queue, which the other threads must steal from
+         */
+        for( int i = 0; i < 16; ++i )
+            pool.submit( [&count, i]() {
+                if( i % 4 == 0 )
+                    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+                ++count;
+            } );
+    }
+
+    EXPECT_EQ( count, 16 );
+    EXPECT_LT( std::chrono::steady_clock::now() - start, std::chrono::milliseconds( 4 * 50 + 150 ) );
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "regex/language/ast.h"
+#include "regex/language/utf8.h"
+#include "regex/utilities/compile.h"
+
+using regex::language::character_class;
+using regex::language::syntax_flag;
+
+TEST( utf8, decode )
+{
+    const std::string text = "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+    std::size_t position = 0;
+
+    EXPECT_EQ( regex::language::utf8::decode( text, position ), 'a' );
+    EXPECT_EQ( regex::language::utf8::decode( text, position ), 0xE9u );
+    EXPECT_EQ( regex::language::utf8::decode( text, position ), 0x20ACu );
+    EXPECT_EQ( regex::language::utf8::decode( text, position ), 0x1F600u );
+    EXPECT_EQ( position, text.size() );
+}
+
+TEST( utf8, decode_invalid )
+{
+    for( const std::string text : { "\x80", "\xc3", "\xc0\x80", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xe2\x28\xa1" } )
+    {
+        std::size_t position = 0;
+        EXPECT_THROW( regex::language::utf8::decode( text, position ), std::runtime_error ) << text;
+    }
+}
+
+TEST( utf8, encode )
+{
+    for( const character_class::code_point c : { 0x24u, 0xA2u, 0x20ACu, 0xD7FFu, 0x10348u, 0x10FFFFu } )
+    {
+        std::string encoded;
+        regex::language::utf8::encode( c, encoded );
+        std::size_t position = 0;
+
+        EXPECT_EQ( regex::language::utf8::decode( encoded, position ), c );
+        EXPECT_EQ( position, encoded.size() );
+    }
+}
+
+TEST( utf8, sequences )
+{
+    using sequence = regex::language::utf8::sequence;
+
+    EXPECT_EQ( regex::language::utf8::sequences( character_class( 'a', 'z' ) ),
+               ( std::vector<sequence>{ { { { { 'a', 'z' } } }, 1 } } ) );
+    EXPECT_EQ( regex::language::utf8::sequences( character_class( 0x80, 0x7FF ) ),
+               ( std::vector<sequence>{ { { { { 0xC2, 0xDF }, { 0x80, 0xBF } } }, 2 } } ) );
+    EXPECT_EQ( regex::language::utf8::sequences( character_class( 0xE9, 0x100 ) ),
+               ( std::vector<sequence>{ { { { { 0xC3, 0xC3 }, { 0xA9, 0xBF } } }, 2 },
+                                        { { { { 0xC4, 0xC4 }, { 0x80, 0x80 } } }, 2 } } ) );
+}
+
+TEST( utf8, sequences_cover_every_code_point )
+{
+    const auto all = regex::language::utf8::sequences( character_class( 0, character_class::code_point_max ) );
+
+    for( const character_class::code_point c : { 0x0u, 0x7Fu, 0x80u, 0x7FFu, 0x800u, 0xFFFu, 0x1000u, 0xD7FFu, 0xE000u,
+                                                 0xFFFFu, 0x10000u, 0x3FFFFu, 0x40000u, 0x10FFFFu } )
+    {
+        std::string encoded;
+        regex::language::utf8::encode( c, encoded );
+
+        const auto matches = std::count_if( std::cbegin( all ), std::cend( all ), [&]( const auto &s ) {
+            if( s.size != encoded.size() )
+                return false;
+
+            for( std::size_t i = 0; i < s.size; ++i )
+            {
+                const auto byte = static_cast<unsigned char>( encoded[i] );
+
+                if( byte < s.bytes[i].lower || byte > s.bytes[i].upper )
+                    return false;
+            }
+
+            return true;
+        } );
+
+        EXPECT_EQ( matches, 1 ) << std::hex << c;
+    }
+}
+
+TEST( utf8, parse )
+{
+    const auto a = regex::language::parse( "\xc3\xa9+[\xce\xb1-\xcf\x89]\\x{1f600}", syntax_flag::utf8 );
+
+    ASSERT_EQ( a.classes().size(), 3u );
+    EXPECT_EQ( a.classes()[0], character_class( 0xE9, 0xE9 ) );
+    EXPECT_EQ( a.classes()[1], character_class( 0x3B1, 0x3C9 ) );
+    EXPECT_EQ( a.classes()[2], character_class( 0x1F600, 0x1F600 ) );
+    EXPECT_EQ( regex::language::to_string( a ), "\\xe9+[\\x{3b1}-\\x{3c9}]\\x{1f600}" );
+
+    EXPECT_THROW( regex::language::parse( "\xc3", syntax_flag::utf8 ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse( "\\x{110000}", syntax_flag::utf8 ), std::runtime_error );
+    EXPECT_THROW( regex::language::parse( "\\x{100}" ), std::runtime_error );
+}
+
+TEST( utf8, match )
+{
+    for( const auto flag : { regex::compile_flag::nfa, regex::compile_flag::dfa } )
+    {
+        const auto any = regex::compile( "a.c", flag, syntax_flag::utf8 );
+
+        EXPECT_TRUE( any->execute( "abc" ) );
+        EXPECT_TRUE( any->execute( "a\xc3\xa9"
+                                   "c" ) );
+        EXPECT_TRUE( any->execute( "a\xf0\x9f\x98\x80"
+                                   "c" ) );
+        EXPECT_FALSE( any->execute( "a\xc3"
+                                    "c" ) );
+        EXPECT_FALSE( any->execute( "a\xed\xa0\x80"
+                                    "c" ) );
+        EXPECT_FALSE( regex::compile( "a.c", flag )->execute( "a\xc3\xa9"
+                                                              "c" ) );
+
+        const auto greek = regex::compile( "[\xce\xb1-\xcf\x89]+", flag, syntax_flag::utf8 );
+
+        EXPECT_TRUE( greek->execute( "\xce\xbb\xce\xbf\xce\xb3\xce\xbf\xcf\x82" ) );
+        EXPECT_FALSE( greek->execute( "\xce\x9b" ) );
+
+        const auto repeated = regex::compile( "\xc3\xa9{2}", flag, syntax_flag::utf8 );
+
+        EXPECT_TRUE( repeated->execute( "\xc3\xa9\xc3\xa9" ) );
+        EXPECT_FALSE( repeated->execute( "\xc3\xa9\xa9" ) );
+
+        const auto negated = regex::compile( "[^a]\\W", flag, syntax_flag::utf8 );
+
+        EXPECT_TRUE( negated->execute( "\xe2\x82\xac\xe2\x82\xac" ) );
+        EXPECT_FALSE( negated->execute( "a\xe2\x82\xac" ) );
+    }
+}